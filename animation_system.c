@@ -0,0 +1,53 @@
+#include <string.h>
+#include <SDL.h>
+#include "animation_system.h"
+#include "growable.h"
+
+static ARRAY(AnimationState) animations;   // count: slots ever used; handles index it
+static int animation_high_water = 0;       // loop bound; slots past it are unused
+
+int animation_register(int frame_count, float frame_delay_ms) {
+    if (frame_count <= 0) return -1;
+
+    // A released slot first, else a new one at the end
+    int i = 0;
+    while (i < animations.count && animations.items[i].frame_count != 0) i++;
+    if (i == animations.count && !array_push(&animations, (AnimationState){ 0 })) {
+        SDL_Log("Out of memory for animation %d", i);
+        return -1;
+    }
+
+    animations.items[i].frame_count = frame_count;
+    animations.items[i].current_frame = 0;
+    animations.items[i].frame_timer = 0.0f;
+    animations.items[i].frame_delay_ms = frame_delay_ms > 0.0f ? frame_delay_ms : 1.0f;
+    if (i >= animation_high_water) animation_high_water = i + 1;
+    return i;
+}
+
+void animation_release(int handle) {
+    if (handle < 0 || handle >= animations.count) return;
+    memset(&animations.items[handle], 0, sizeof(AnimationState));
+
+    while (animation_high_water > 0 && animations.items[animation_high_water - 1].frame_count == 0)
+        animation_high_water--;
+}
+
+void animation_tick(float delta_ms) {
+    for (int i = 0; i < animation_high_water; i++) {
+        AnimationState* a = &animations.items[i];
+        if (a->frame_count == 0) continue;
+
+        // Keep the remainder so playback speed does not depend on frame rate
+        a->frame_timer += delta_ms;
+        while (a->frame_timer >= a->frame_delay_ms) {
+            a->frame_timer -= a->frame_delay_ms;
+            a->current_frame = (a->current_frame + 1) % a->frame_count;
+        }
+    }
+}
+
+int animation_current_frame(int handle) {
+    if (handle < 0 || handle >= animations.count) return 0;
+    return animations.items[handle].current_frame;
+}
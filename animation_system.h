@@ -0,0 +1,25 @@
+#ifndef ANIMATION_SYSTEM_H
+#define ANIMATION_SYSTEM_H
+
+#include <stdbool.h>
+
+// Flipbook playback state; lives in one contiguous, growable array owned by
+// the system
+typedef struct {
+    int frame_count;        // 0 marks a free slot
+    int current_frame;
+    float frame_timer;      // ms accumulated toward the next frame
+    float frame_delay_ms;
+} AnimationState;
+
+// Returns a handle, or -1 (logged) when out of memory
+int  animation_register(int frame_count, float frame_delay_ms);
+void animation_release(int handle);
+
+// Advance every animation by the real frame delta; call once per frame
+void animation_tick(float delta_ms);
+
+// Pure read for renderers
+int animation_current_frame(int handle);
+
+#endif
@@ -0,0 +1,472 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <SDL.h>
+#include <SDL_image.h>
+#include "asset_loader.h"
+#include "asset_pack.h"
+#include "hitbox_loader.h"
+#include "rotation_cache.h"
+#include "entity.h"
+#include "growable.h"
+
+#define MAX_ASSET_WORKERS 16
+#define ASSET_INDEX_MIN_SLOTS 64     // power of two
+#define ISSUED_TEXTURE_MIN_SLOTS 64  // power of two
+
+struct AssetFuture {
+    char* path;
+    AssetKind kind;
+    SDL_atomic_t state;          // AssetState, published by the worker last
+    SDL_Surface* surface;        // decoded pixels, kept for further uploads
+    SDL_Texture* texture;        // eager upload, handed to the first taker
+    HitboxFile hitbox;
+    struct AssetFuture* next_done;
+    int index;                   // position in futures
+};
+
+// Paged, so the futures workers are decoding never move as more are requested
+static POOL(AssetFuture) futures;
+static int future_count = 0;
+static ARRAY(int) future_index;  // open addressing, -1 = empty; count: table size, a power of two
+
+// Job queue: main thread pushes, workers pop from job_head; both under job_lock
+static ARRAY(AssetFuture*) job_queue;
+static int job_head = 0;
+static SDL_mutex* job_lock = NULL;
+static SDL_cond* job_cond = NULL;
+
+// Completed list: workers push, main thread drains in asset_loader_pump
+static AssetFuture* done_list = NULL;
+static SDL_mutex* done_lock = NULL;
+static SDL_cond* done_cond = NULL;
+
+static SDL_Thread* workers[MAX_ASSET_WORKERS];
+static int worker_count = 0;
+static bool shutting_down = false;
+static SDL_Renderer* upload_renderer = NULL;
+static SDL_atomic_t finished_count;
+
+// Texture -> future it was uploaded from, so a reload can find every copy
+typedef struct {
+    SDL_Texture* texture;
+    int future;
+} IssuedTexture;
+
+#define ISSUED_EMPTY ((SDL_Texture*)0)
+#define ISSUED_TOMBSTONE ((SDL_Texture*)1)
+
+static ARRAY(IssuedTexture) issued;  // open addressed; count: table size, a power of two
+static int issued_count = 0;         // live entries
+static int issued_filled = 0;        // live entries plus tombstones
+
+static Uint32 hash_path(const char* s) {
+    Uint32 h = 2166136261u;  // FNV-1a
+    while (*s) {
+        h ^= (Uint8)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static AssetFuture* find_future(const char* path) {
+    if (future_count == 0) return NULL;
+    Uint32 mask = (Uint32)future_index.count - 1;
+    for (Uint32 i = hash_path(path) & mask;; i = (i + 1) & mask) {
+        int idx = future_index.items[i];
+        if (idx < 0) return NULL;
+        AssetFuture* f = pool_at(&futures, idx);
+        if (strcmp(f->path, path) == 0) return f;
+    }
+}
+
+static void index_future(int idx) {
+    Uint32 mask = (Uint32)future_index.count - 1;
+    Uint32 slot = hash_path(pool_at(&futures, idx)->path) & mask;
+    while (future_index.items[slot] >= 0) slot = (slot + 1) & mask;
+    future_index.items[slot] = idx;
+}
+
+// Double the path index and re-add every future; it stays under half load
+static bool grow_future_index(void) {
+    int size = future_index.count ? future_index.count * 2 : ASSET_INDEX_MIN_SLOTS;
+    int* table = malloc(sizeof(int) * size);
+    if (!table) return false;
+    memset(table, -1, sizeof(int) * size);
+    free(future_index.items);
+    future_index.items = table;
+    future_index.count = future_index.capacity = size;
+    for (int i = 0; i < future_count; i++)
+        index_future(i);
+    return true;
+}
+
+static Uint32 hash_texture(const SDL_Texture* t) {
+    Uint64 v = (Uint64)(uintptr_t)t;
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    return (Uint32)v;
+}
+
+static int find_issued(const SDL_Texture* t) {
+    if (!issued.count) return -1;
+    Uint32 mask = (Uint32)issued.count - 1;
+    Uint32 i = hash_texture(t) & mask;
+    for (int n = 0; n < issued.count; n++, i = (i + 1) & mask) {
+        if (issued.items[i].texture == ISSUED_EMPTY) return -1;
+        if (issued.items[i].texture == t) return (int)i;
+    }
+    return -1;
+}
+
+static void insert_issued(SDL_Texture* t, int future) {
+    Uint32 mask = (Uint32)issued.count - 1;
+    Uint32 i = hash_texture(t) & mask;
+    while (issued.items[i].texture != ISSUED_EMPTY && issued.items[i].texture != ISSUED_TOMBSTONE)
+        i = (i + 1) & mask;
+    if (issued.items[i].texture == ISSUED_EMPTY) issued_filled++;
+    issued.items[i].texture = t;
+    issued.items[i].future = future;
+    issued_count++;
+}
+
+// Rebuild with room for one more texture at under half load; drops tombstones
+static bool rehash_issued(void) {
+    int size = issued.count ? issued.count : ISSUED_TEXTURE_MIN_SLOTS;
+    while (2 * (issued_count + 1) > size) size *= 2;
+    IssuedTexture* table = calloc(size, sizeof(IssuedTexture));
+    if (!table) return false;
+    IssuedTexture* old = issued.items;
+    int old_size = issued.count;
+    issued.items = table;
+    issued.count = issued.capacity = size;
+    issued_count = issued_filled = 0;
+    for (int i = 0; i < old_size; i++) {
+        if (old[i].texture != ISSUED_EMPTY && old[i].texture != ISSUED_TOMBSTONE)
+            insert_issued(old[i].texture, old[i].future);
+    }
+    free(old);
+    return true;
+}
+
+static void track_texture(SDL_Texture* t, AssetFuture* f) {
+    // Tombstones count toward the load, or probes for misses would never end
+    if (2 * (issued_filled + 1) > issued.count && !rehash_issued()) {
+        SDL_Log("Out of memory tracking a texture of %s; it will not hot-reload", f->path);
+        return;
+    }
+    insert_issued(t, f->index);
+}
+
+// Every texture made from a decoded surface goes through here
+static SDL_Texture* upload_surface(SDL_Renderer* renderer, AssetFuture* f) {
+    SDL_Texture* t = SDL_CreateTextureFromSurface(renderer, f->surface);
+    if (!t) {
+        SDL_Log("Failed to create texture for %s: %s", f->path, SDL_GetError());
+        return NULL;
+    }
+    rotation_cache_register(t, f->surface);
+    track_texture(t, f);
+    return t;
+}
+
+void asset_release_texture(SDL_Texture* texture) {
+    if (!texture) return;
+    int slot = find_issued(texture);
+    if (slot >= 0) {
+        issued.items[slot].texture = ISSUED_TOMBSTONE;
+        issued_count--;
+    }
+    rotation_cache_forget(texture);
+    SDL_DestroyTexture(texture);
+}
+
+static void decode_future(AssetFuture* f) {
+    bool ok = false;
+    if (f->kind == ASSET_IMAGE) {
+        // Packed pixels are used in place; the file is the fallback
+        f->surface = asset_pack_surface(f->path);
+        if (!f->surface) f->surface = IMG_Load(f->path);
+        if (!f->surface)
+            SDL_Log("IMG_Load failed for %s: %s", f->path, IMG_GetError());
+        ok = f->surface != NULL;
+    } else {
+        ok = asset_pack_hitbox(f->path, &f->hitbox) || hitbox_file_parse(f->path, &f->hitbox);
+    }
+    SDL_AtomicSet(&f->state, ok ? ASSET_READY : ASSET_FAILED);
+    SDL_AtomicAdd(&finished_count, 1);
+}
+
+static int worker_main(void* arg) {
+    (void)arg;
+    for (;;) {
+        SDL_LockMutex(job_lock);
+        while (job_head == job_queue.count && !shutting_down)
+            SDL_CondWait(job_cond, job_lock);
+        if (job_head == job_queue.count && shutting_down) {
+            SDL_UnlockMutex(job_lock);
+            return 0;
+        }
+        AssetFuture* f = job_queue.items[job_head++];
+        // Drained: start over at the front instead of growing forever
+        if (job_head == job_queue.count) job_head = job_queue.count = 0;
+        SDL_UnlockMutex(job_lock);
+
+        decode_future(f);
+
+        SDL_LockMutex(done_lock);
+        f->next_done = done_list;
+        done_list = f;
+        SDL_CondBroadcast(done_cond);
+        SDL_UnlockMutex(done_lock);
+    }
+}
+
+bool asset_loader_init(SDL_Renderer* renderer, int count) {
+    if (worker_count > 0) return true;
+
+    if (count <= 0) count = SDL_GetCPUCount();
+    if (count > MAX_ASSET_WORKERS) count = MAX_ASSET_WORKERS;
+    if (count < 1) count = 1;
+
+    job_lock = SDL_CreateMutex();
+    job_cond = SDL_CreateCond();
+    done_lock = SDL_CreateMutex();
+    done_cond = SDL_CreateCond();
+    if (!job_lock || !job_cond || !done_lock || !done_cond) {
+        SDL_Log("Asset loader init failed: %s", SDL_GetError());
+        return false;
+    }
+
+    // Before the workers start: they only read the mapping
+    asset_pack_open(asset_pack_path());
+
+    upload_renderer = renderer;
+    shutting_down = false;
+    for (int i = 0; i < count; i++) {
+        workers[worker_count] = SDL_CreateThread(worker_main, "asset_worker", NULL);
+        if (!workers[worker_count]) {
+            SDL_Log("Failed to start asset worker: %s", SDL_GetError());
+            break;
+        }
+        worker_count++;
+    }
+    return worker_count > 0;
+}
+
+static AssetFuture* request(const char* path, AssetKind kind) {
+    AssetFuture* f = find_future(path);
+    if (f) return f;
+
+    // Both grow before the future exists, so a failure leaves nothing half-added
+    char* copy = strdup(path);
+    if (!copy || !pool_reserve(&futures, future_count + 1) ||
+        (2 * (future_count + 1) > future_index.count && !grow_future_index())) {
+        SDL_Log("Out of memory for asset %s", path);
+        free(copy);
+        return NULL;
+    }
+
+    int idx = future_count++;
+    f = pool_at(&futures, idx);
+    memset(f, 0, sizeof(*f));
+    f->path = copy;
+    f->kind = kind;
+    f->index = idx;
+    SDL_AtomicSet(&f->state, ASSET_PENDING);
+    index_future(idx);
+
+    if (worker_count == 0) {
+        // No pool: decode right here
+        decode_future(f);
+        return f;
+    }
+
+    SDL_LockMutex(job_lock);
+    bool queued = array_push(&job_queue, f);
+    if (queued) SDL_CondSignal(job_cond);
+    SDL_UnlockMutex(job_lock);
+    if (!queued) {
+        // Out of queue space: decode here; the upload happens on first take
+        SDL_Log("Out of memory queueing %s, decoding in place", path);
+        decode_future(f);
+    }
+    return f;
+}
+
+AssetFuture* asset_request_image(const char* path) {
+    return request(path, ASSET_IMAGE);
+}
+
+AssetFuture* asset_request_hitbox(const char* path) {
+    return request(path, ASSET_HITBOX);
+}
+
+AssetState asset_future_state(AssetFuture* f) {
+    if (!f) return ASSET_FAILED;
+    return (AssetState)SDL_AtomicGet(&f->state);
+}
+
+int asset_loader_pump(void) {
+    if (worker_count == 0) return 0;
+
+    SDL_LockMutex(done_lock);
+    AssetFuture* list = done_list;
+    done_list = NULL;
+    SDL_UnlockMutex(done_lock);
+
+    int uploaded = 0;
+    for (AssetFuture* f = list; f; f = f->next_done) {
+        if (f->kind != ASSET_IMAGE || !f->surface || f->texture || !upload_renderer) continue;
+        f->texture = upload_surface(upload_renderer, f);
+        if (f->texture) uploaded++;
+    }
+    return uploaded;
+}
+
+bool asset_wait(AssetFuture* f) {
+    if (!f) return false;
+
+    while (asset_future_state(f) == ASSET_PENDING) {
+        SDL_LockMutex(done_lock);
+        if (!done_list && asset_future_state(f) == ASSET_PENDING)
+            SDL_CondWaitTimeout(done_cond, done_lock, 5);
+        SDL_UnlockMutex(done_lock);
+        asset_loader_pump();
+    }
+    asset_loader_pump();
+    return asset_future_state(f) == ASSET_READY;
+}
+
+const HitboxFile* asset_wait_hitbox(AssetFuture* f) {
+    if (!f || f->kind != ASSET_HITBOX || !asset_wait(f)) return NULL;
+    return &f->hitbox;
+}
+
+bool asset_image_size(const char* path, int* w, int* h) {
+    AssetFuture* f = asset_request_image(path);
+    if (!f || f->kind != ASSET_IMAGE || !asset_wait(f) || !f->surface) return false;
+    *w = f->surface->w;
+    *h = f->surface->h;
+    return true;
+}
+
+SDL_Texture* asset_take_texture(SDL_Renderer* renderer, const char* path) {
+    AssetFuture* f = asset_request_image(path);
+    if (!f || f->kind != ASSET_IMAGE || !asset_wait(f)) return NULL;
+
+    if (f->texture && renderer == upload_renderer) {
+        SDL_Texture* t = f->texture;
+        f->texture = NULL;
+        return t;
+    }
+
+    return upload_surface(renderer, f);
+}
+
+static bool issued_from(int slot, int future) {
+    SDL_Texture* t = issued.items[slot].texture;
+    return t != ISSUED_EMPTY && t != ISSUED_TOMBSTONE && issued.items[slot].future == future;
+}
+
+// Same size: new pixels into the existing texture, so every holder sees them
+static bool refresh_texture(SDL_Texture* t, SDL_Surface* surface) {
+    Uint32 format;
+    int w, h;
+    if (SDL_QueryTexture(t, &format, NULL, &w, &h) != 0) return false;
+    if (w != surface->w || h != surface->h) return false;
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+    if (!converted) return false;
+    int rc = SDL_UpdateTexture(t, NULL, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+    return rc == 0;
+}
+
+int asset_replace_image(SDL_Renderer* renderer, const char* path, SDL_Surface* surface) {
+    AssetFuture* f = find_future(path);
+    if (!f || f->kind != ASSET_IMAGE || !f->surface) {
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+
+    int idx = f->index;
+    int count = 0;
+    for (int i = 0; i < issued.count; i++) {
+        if (issued_from(i, idx)) count++;
+    }
+    SDL_Texture** textures = count ? malloc(sizeof(SDL_Texture*) * count) : NULL;
+    if (count && !textures) {
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    int n = 0;
+    for (int i = 0; i < issued.count && n < count; i++) {
+        if (issued_from(i, idx))
+            textures[n++] = issued.items[i].texture;
+    }
+
+    rotation_cache_replace_source(f->surface, surface);
+    SDL_FreeSurface(f->surface);
+    f->surface = surface;
+
+    for (int i = 0; i < n; i++) {
+        SDL_Texture* old = textures[i];
+        if (refresh_texture(old, surface)) continue;
+
+        // Resized (or the update failed): a new texture takes its place
+        SDL_Texture* t = upload_surface(renderer, f);
+        if (!t) continue;
+        entity_retarget_texture(old, t);
+        if (f->texture == old) f->texture = t;
+        asset_release_texture(old);
+    }
+    free(textures);
+    return n;
+}
+
+void asset_loader_progress(int* done, int* total) {
+    if (done) *done = SDL_AtomicGet(&finished_count);
+    if (total) *total = future_count;
+}
+
+void asset_loader_shutdown(void) {
+    if (worker_count > 0) {
+        SDL_LockMutex(job_lock);
+        shutting_down = true;
+        SDL_CondBroadcast(job_cond);
+        SDL_UnlockMutex(job_lock);
+
+        for (int i = 0; i < worker_count; i++)
+            SDL_WaitThread(workers[i], NULL);
+        worker_count = 0;
+
+        SDL_DestroyCond(job_cond);
+        SDL_DestroyMutex(job_lock);
+        SDL_DestroyCond(done_cond);
+        SDL_DestroyMutex(done_lock);
+        job_cond = done_cond = NULL;
+        job_lock = done_lock = NULL;
+    }
+
+    for (int i = 0; i < future_count; i++) {
+        AssetFuture* f = pool_at(&futures, i);
+        asset_release_texture(f->texture);
+        if (f->surface) SDL_FreeSurface(f->surface);
+        hitbox_file_free(&f->hitbox);
+        free(f->path);
+    }
+    // Packed surfaces point into the mapping, so they had to go first
+    asset_pack_close();
+    pool_free(&futures);
+    future_count = 0;
+    array_free(&future_index);
+    array_free(&issued);
+    issued_count = issued_filled = 0;
+    array_free(&job_queue);
+    job_head = 0;
+    done_list = NULL;
+    upload_renderer = NULL;
+    SDL_AtomicSet(&finished_count, 0);
+}
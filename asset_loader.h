@@ -0,0 +1,57 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "hitbox_loader.h"
+
+typedef enum {
+    ASSET_IMAGE,
+    ASSET_HITBOX
+} AssetKind;
+
+typedef enum {
+    ASSET_PENDING,
+    ASSET_READY,
+    ASSET_FAILED
+} AssetState;
+
+typedef struct AssetFuture AssetFuture;
+
+// Start the decode pool; worker_count <= 0 uses one worker per CPU core.
+// Without init, requests are decoded synchronously on the calling thread.
+// Init also maps the asset pack (asset_pack.h) when there is one.
+bool asset_loader_init(SDL_Renderer* renderer, int worker_count);
+void asset_loader_shutdown(void);
+
+// Queue a decode; repeated requests for the same path share one future
+AssetFuture* asset_request_image(const char* path);
+AssetFuture* asset_request_hitbox(const char* path);
+AssetState   asset_future_state(AssetFuture* f);
+
+// Main thread: upload every decoded surface that arrived since the last call
+int asset_loader_pump(void);
+
+// Block on a future, uploading other results while waiting
+bool asset_wait(AssetFuture* f);
+const HitboxFile* asset_wait_hitbox(AssetFuture* f);
+
+// Pixel size of an image, waiting for its decode; no texture is made
+bool asset_image_size(const char* path, int* w, int* h);
+
+// Returns a texture owned by the caller (first caller gets the eager upload)
+SDL_Texture* asset_take_texture(SDL_Renderer* renderer, const char* path);
+
+// Destroy a texture from asset_take_texture
+void asset_release_texture(SDL_Texture* texture);
+
+// Hot reload: swap a freshly decoded image (ownership passes here) into every
+// live texture of path. Same-size textures are updated in place; resized ones
+// are recreated and retargeted in the entity pool. Returns the number of
+// textures touched, or -1 if path was never loaded.
+int asset_replace_image(SDL_Renderer* renderer, const char* path, SDL_Surface* surface);
+
+// Loading progress counter: finished (ready or failed) vs requested
+void asset_loader_progress(int* done, int* total);
+
+#endif
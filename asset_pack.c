@@ -0,0 +1,398 @@
+#define _XOPEN_SOURCE 700
+#include <ftw.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <SDL_image.h>
+#include "asset_pack.h"
+#include "asset_loader.h"
+#include "growable.h"
+
+#define PACK_MAGIC 0x4b415054u      // "TPAK"
+#define PACK_VERSION 1
+#define PACK_ALIGN 64               // every entry starts cache-line aligned
+
+// Native byte order: the pack is built on the machine (or the platform) it
+// runs on, by the same binary
+typedef struct {
+    Uint32 magic;
+    Uint32 version;
+    Uint32 entry_count;
+    float hitbox_tolerance;         // simplification the shapes were packed with
+    Uint64 index_offset;
+} PackHeader;
+
+typedef struct {
+    char path[ASSET_PACK_PATH_MAX]; // as requested from the loader, e.g. "assets/tank.png"
+    Uint32 kind;                    // AssetKind
+    Uint32 format;                  // image: SDL pixel format
+    Uint32 shape_count;             // hitbox
+    Sint32 w, h, pitch;             // image
+    Uint64 offset, size;
+    Sint64 source_mtime;            // the source as packed
+    Uint64 source_size;
+} PackEntry;
+
+// Hitbox entry: the shape table, then every point array, then the labels.
+// Offsets are from the start of the entry.
+typedef struct {
+    Uint32 label;
+    Uint32 points;
+    Sint32 point_count, source_point_count;
+    float radius;
+    Uint32 layer, mask;
+} PackShape;
+
+static Uint8* pack_base = NULL;
+static size_t pack_size = 0;
+static const PackEntry* pack_index = NULL;
+static int pack_entries = 0;
+static bool pack_hitboxes = false;  // packed with the tolerance in effect now
+
+const char* asset_pack_path(void) {
+    const char* env = SDL_getenv("TANK_ASSET_PACK");
+    return env ? env : ASSET_PACK_DEFAULT_PATH;
+}
+
+// Build
+
+typedef struct {
+    char* path;
+    AssetKind kind;
+} PackSource;
+
+static ARRAY(PackSource) sources;
+static AssetKind walk_kind;         // nftw passes no user data
+
+static int collect_source(const char* fpath, const struct stat* sb, int typeflag, struct FTW* ftwbuf) {
+    (void)sb;
+    (void)ftwbuf;
+
+    const char* ext = walk_kind == ASSET_IMAGE ? ".png" : ".json";
+    size_t n = strlen(fpath), ext_len = strlen(ext);
+    if (typeflag != FTW_F || n < ext_len || strcmp(fpath + n - ext_len, ext) != 0) return 0;
+    if (n >= ASSET_PACK_PATH_MAX) {
+        SDL_Log("Asset pack: path too long, not packed: %s", fpath);
+        return 0;
+    }
+
+    PackSource s = { strdup(fpath), walk_kind };
+    if (!s.path || !array_push(&sources, s)) {
+        SDL_Log("Out of memory listing %s", fpath);
+        free(s.path);
+        return 1;   // stops the walk
+    }
+    return 0;
+}
+
+static int compare_sources(const void* a, const void* b) {
+    return strcmp(((const PackSource*)a)->path, ((const PackSource*)b)->path);
+}
+
+static bool pad_to_alignment(FILE* out) {
+    static const Uint8 zeros[PACK_ALIGN];
+    long pos = ftell(out);
+    if (pos < 0) return false;
+    size_t pad = (PACK_ALIGN - (size_t)pos % PACK_ALIGN) % PACK_ALIGN;
+    return fwrite(zeros, 1, pad, out) == pad;
+}
+
+// Nothing is written unless the source decodes
+static bool write_image(FILE* out, const char* path, PackEntry* e) {
+    SDL_Surface* loaded = IMG_Load(path);
+    if (!loaded) {
+        SDL_Log("IMG_Load failed for %s: %s", path, IMG_GetError());
+        return false;
+    }
+    SDL_Surface* s = SDL_ConvertSurfaceFormat(loaded, ASSET_PACK_PIXEL_FORMAT, 0);
+    SDL_FreeSurface(loaded);
+    if (!s) {
+        SDL_Log("Asset pack: cannot convert %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    e->format = s->format->format;
+    e->w = s->w;
+    e->h = s->h;
+    e->pitch = s->pitch;
+    e->size = (Uint64)s->pitch * (Uint64)s->h;
+    bool ok = fwrite(s->pixels, 1, e->size, out) == e->size;
+    SDL_FreeSurface(s);
+    return ok;
+}
+
+static bool write_hitbox(FILE* out, const char* path, PackEntry* e) {
+    HitboxFile hf;
+    if (!hitbox_file_parse(path, &hf)) {
+        SDL_Log("Asset pack: cannot parse %s", path);
+        return false;
+    }
+
+    PackShape* table = calloc(hf.shape_count > 0 ? hf.shape_count : 1, sizeof(PackShape));
+    if (!table) {
+        hitbox_file_free(&hf);
+        return false;
+    }
+    Uint32 at = (Uint32)(sizeof(PackShape) * hf.shape_count);
+    for (int i = 0; i < hf.shape_count; i++) {
+        table[i].points = at;
+        at += (Uint32)(sizeof(SDL_Point) * hf.shapes[i].point_count);
+    }
+    for (int i = 0; i < hf.shape_count; i++) {
+        const HitboxShape* hs = &hf.shapes[i];
+        table[i].label = at;
+        at += (Uint32)strlen(hs->label) + 1;
+        table[i].point_count = hs->point_count;
+        table[i].source_point_count = hs->source_point_count;
+        table[i].radius = hs->radius;
+        table[i].layer = hs->layer;
+        table[i].mask = hs->mask;
+    }
+
+    bool ok = fwrite(table, sizeof(PackShape), hf.shape_count, out) == (size_t)hf.shape_count;
+    for (int i = 0; i < hf.shape_count && ok; i++)
+        ok = fwrite(hf.shapes[i].points, sizeof(SDL_Point), hf.shapes[i].point_count, out) ==
+             (size_t)hf.shapes[i].point_count;
+    for (int i = 0; i < hf.shape_count && ok; i++)
+        ok = fputs(hf.shapes[i].label, out) >= 0 && fputc('\0', out) != EOF;
+
+    e->shape_count = (Uint32)hf.shape_count;
+    e->size = at;
+    free(table);
+    hitbox_file_free(&hf);
+    return ok;
+}
+
+static void free_sources(void) {
+    for (int i = 0; i < sources.count; i++)
+        free(sources.items[i].path);
+    array_free(&sources);
+}
+
+// A root that cannot be walked fails the build rather than packing less
+static bool walk_sources(const char* root, AssetKind kind) {
+    walk_kind = kind;
+    int rc = nftw(root, collect_source, 10, FTW_PHYS);
+    if (rc == -1) SDL_Log("Asset pack: cannot walk %s: %s", root, strerror(errno));
+    return rc == 0;     // 1: collect_source stopped it and logged why
+}
+
+bool asset_pack_build(const char* pack_path, const char* image_root, const char* hitbox_root) {
+    if (!walk_sources(image_root, ASSET_IMAGE) || !walk_sources(hitbox_root, ASSET_HITBOX)) {
+        free_sources();
+        return false;
+    }
+    // Sorted sources give a sorted index: lookups bsearch the mapping
+    if (sources.count > 0)
+        qsort(sources.items, sources.count, sizeof(PackSource), compare_sources);
+
+    char tmp_path[1024];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", pack_path);
+    FILE* out = fopen(tmp_path, "wb");
+    PackEntry* index = calloc(sources.count > 0 ? sources.count : 1, sizeof(PackEntry));
+    if (!out || !index) {
+        SDL_Log("Asset pack: cannot write %s", tmp_path);
+        if (out) fclose(out);
+        free(index);
+        free_sources();
+        return false;
+    }
+
+    PackHeader header = { PACK_MAGIC, PACK_VERSION, 0, hitbox_simplify_tolerance(), 0 };
+    fwrite(&header, sizeof(header), 1, out);
+
+    int images = 0, hitboxes = 0;
+    for (int i = 0; i < sources.count && !ferror(out); i++) {
+        const PackSource* src = &sources.items[i];
+        struct stat st;
+        if (stat(src->path, &st) != 0) continue;
+
+        PackEntry* e = &index[images + hitboxes];
+        memset(e, 0, sizeof(*e));
+        strcpy(e->path, src->path);
+        e->kind = src->kind;
+        e->source_mtime = (Sint64)st.st_mtime;
+        e->source_size = (Uint64)st.st_size;
+        if (!pad_to_alignment(out)) break;
+        e->offset = (Uint64)ftell(out);
+
+        // A source that fails is left out and decoded from its file at runtime
+        if (src->kind == ASSET_IMAGE ? write_image(out, src->path, e) : write_hitbox(out, src->path, e)) {
+            if (src->kind == ASSET_IMAGE) images++;
+            else hitboxes++;
+        }
+    }
+
+    pad_to_alignment(out);
+    header.entry_count = (Uint32)(images + hitboxes);
+    header.index_offset = (Uint64)ftell(out);
+    fwrite(index, sizeof(PackEntry), header.entry_count, out);
+    long total = ftell(out);
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+
+    bool ok = !ferror(out);
+    ok = fclose(out) == 0 && ok;
+    free(index);
+    free_sources();
+    // Renamed into place: a game that has the old pack mapped keeps it
+    if (!ok || rename(tmp_path, pack_path) != 0) {
+        SDL_Log("Asset pack: writing %s failed", pack_path);
+        remove(tmp_path);
+        return false;
+    }
+    printf("Asset pack %s: %d images, %d hitbox files, %.1f MB\n",
+           pack_path, images, hitboxes, (double)total / (1024.0 * 1024.0));
+    return true;
+}
+
+// Runtime
+
+static bool entry_valid(const PackEntry* e) {
+    if (!memchr(e->path, '\0', sizeof(e->path))) return false;
+    if (e->offset > pack_size || e->size > pack_size - e->offset) return false;
+    if (e->kind == ASSET_IMAGE)
+        return e->w > 0 && e->h > 0 && e->pitch >= e->w * 4 &&
+               (Uint64)e->pitch * (Uint64)e->h <= e->size;
+    if (e->kind == ASSET_HITBOX)
+        return (Uint64)e->shape_count * sizeof(PackShape) <= e->size;
+    return false;
+}
+
+// Header, index and every entry's extent; shapes are checked as they are read
+static bool pack_valid(void) {
+    const PackHeader* header = (const PackHeader*)pack_base;
+    if (header->magic != PACK_MAGIC || header->version != PACK_VERSION) return false;
+    if (header->index_offset % PACK_ALIGN != 0 || header->index_offset > pack_size) return false;
+    if ((Uint64)header->entry_count * sizeof(PackEntry) > pack_size - header->index_offset) return false;
+
+    pack_index = (const PackEntry*)(pack_base + header->index_offset);
+    pack_entries = (int)header->entry_count;
+    for (int i = 0; i < pack_entries; i++) {
+        if (!entry_valid(&pack_index[i])) return false;
+    }
+    return true;
+}
+
+bool asset_pack_open(const char* pack_path) {
+    asset_pack_close();
+    if (!pack_path || !*pack_path) return false;
+
+    int fd = open(pack_path, O_RDONLY);
+    if (fd < 0) {
+        // No pack is the normal case during development
+        if (strcmp(pack_path, ASSET_PACK_DEFAULT_PATH) != 0)
+            SDL_Log("Asset pack %s: cannot open", pack_path);
+        return false;
+    }
+    struct stat st;
+    void* map = MAP_FAILED;
+    // Read-only: packed surfaces are only ever read (texture uploads,
+    // conversions, rotation cache copies), so a stray write faults here
+    // instead of quietly diverging from the file
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(PackHeader))
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping keeps the file open
+    if (map == MAP_FAILED) {
+        SDL_Log("Asset pack %s: cannot map", pack_path);
+        return false;
+    }
+
+    pack_base = map;
+    pack_size = (size_t)st.st_size;
+    if (!pack_valid()) {
+        SDL_Log("Asset pack %s: not a version %d pack, ignored", pack_path, PACK_VERSION);
+        asset_pack_close();
+        return false;
+    }
+    // The loader requests most of it right away; start reading ahead now
+    posix_madvise(pack_base, pack_size, POSIX_MADV_WILLNEED);
+
+    float tol = ((const PackHeader*)pack_base)->hitbox_tolerance;
+    pack_hitboxes = tol == hitbox_simplify_tolerance();
+    if (!pack_hitboxes)
+        SDL_Log("Asset pack %s: hitboxes packed at tolerance %.2f, not %.2f; parsing them instead",
+                pack_path, tol, hitbox_simplify_tolerance());
+    SDL_Log("Asset pack %s: %d assets, %.1f MB mapped", pack_path, pack_entries,
+            (double)pack_size / (1024.0 * 1024.0));
+    return true;
+}
+
+void asset_pack_close(void) {
+    if (pack_base) munmap(pack_base, pack_size);
+    pack_base = NULL;
+    pack_size = 0;
+    pack_index = NULL;
+    pack_entries = 0;
+    pack_hitboxes = false;
+}
+
+static int compare_entry(const void* key, const void* entry) {
+    return strcmp((const char*)key, ((const PackEntry*)entry)->path);
+}
+
+// A source that is not shipped is fine; one that was edited since the build wins
+static const PackEntry* find_entry(const char* path, AssetKind kind) {
+    if (!pack_base || !path) return NULL;
+    const PackEntry* e = bsearch(path, pack_index, pack_entries, sizeof(PackEntry), compare_entry);
+    if (!e || e->kind != (Uint32)kind) return NULL;
+
+    struct stat st;
+    if (stat(path, &st) == 0 &&
+        ((Sint64)st.st_mtime != e->source_mtime || (Uint64)st.st_size != e->source_size))
+        return NULL;
+    return e;
+}
+
+SDL_Surface* asset_pack_surface(const char* path) {
+    const PackEntry* e = find_entry(path, ASSET_IMAGE);
+    if (!e) return NULL;
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormatFrom(pack_base + e->offset, e->w, e->h, 32, e->pitch, e->format);
+    if (!s) SDL_Log("Asset pack: no surface for %s: %s", path, SDL_GetError());
+    return s;
+}
+
+bool asset_pack_hitbox(const char* path, HitboxFile* out) {
+    memset(out, 0, sizeof(*out));
+    if (!pack_hitboxes) return false;
+    const PackEntry* e = find_entry(path, ASSET_HITBOX);
+    if (!e) return false;
+    if (e->shape_count == 0) return true;
+
+    const Uint8* data = pack_base + e->offset;
+    const PackShape* table = (const PackShape*)data;
+    out->shapes = calloc(e->shape_count, sizeof(HitboxShape));
+    if (!out->shapes) return false;
+
+    for (Uint32 i = 0; i < e->shape_count; i++) {
+        const PackShape* ps = &table[i];
+        if (ps->point_count < 1 || ps->points > e->size ||
+            (Uint64)ps->point_count * sizeof(SDL_Point) > e->size - ps->points ||
+            ps->label >= e->size || !memchr(data + ps->label, '\0', e->size - ps->label)) {
+            SDL_Log("Asset pack: bad hitbox data for %s", path);
+            hitbox_file_free(out);
+            return false;
+        }
+
+        HitboxShape* hs = &out->shapes[out->shape_count];
+        hs->points = malloc(sizeof(SDL_Point) * ps->point_count);
+        hs->label = strdup((const char*)data + ps->label);
+        out->shape_count++;
+        if (!hs->points || !hs->label) {
+            hitbox_file_free(out);
+            return false;
+        }
+        memcpy(hs->points, data + ps->points, sizeof(SDL_Point) * ps->point_count);
+        hs->point_count = ps->point_count;
+        hs->source_point_count = ps->source_point_count;
+        hs->radius = ps->radius;
+        hs->layer = ps->layer;
+        hs->mask = ps->mask;
+    }
+    return true;
+}
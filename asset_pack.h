@@ -0,0 +1,38 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "hitbox_loader.h"
+
+#define ASSET_PACK_DEFAULT_PATH "assets.pack"
+#define ASSET_PACK_PATH_MAX 128                         // stored asset path, including the NUL
+#define ASSET_PACK_PIXEL_FORMAT SDL_PIXELFORMAT_ARGB8888 // first texture format of SDL's GL, Metal, D3D and software renderers
+
+// One file holding every sprite already decoded to ASSET_PACK_PIXEL_FORMAT,
+// every hitbox file already parsed, and an index sorted by asset path. The
+// runtime maps it read-only and serves surfaces straight from the mapped
+// pixels, so a cold start or level reload costs page-ins instead of PNG
+// decodes and JSON parses. A source file that exists and differs from the
+// one packed (size or mtime) wins over its packed copy.
+
+// Pack every PNG under image_root and every JSON under hitbox_root. Written
+// to a temporary file and renamed, so a running game keeps its mapping.
+bool asset_pack_build(const char* pack_path, const char* image_root, const char* hitbox_root);
+
+// TANK_ASSET_PACK=<file> overrides ASSET_PACK_DEFAULT_PATH; empty disables
+const char* asset_pack_path(void);
+
+// Map a pack; false (quietly, for the default path) when there is none
+bool asset_pack_open(const char* pack_path);
+// Unmap; every surface from asset_pack_surface must be freed first
+void asset_pack_close(void);
+
+// Both are safe from worker threads once the pack is open.
+// A surface over the mapped pixels: no decode, no copy. NULL when the path
+// is not packed or its source changed.
+SDL_Surface* asset_pack_surface(const char* path);
+// Same shapes hitbox_file_parse would give; free with hitbox_file_free
+bool asset_pack_hitbox(const char* path, HitboxFile* out);
+
+#endif
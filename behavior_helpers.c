@@ -58,6 +58,7 @@ void toggle_mount_with_key(
     Entity* child,
     Entity* parent,
     const char* mount_name,
+    const Uint8* keystate,
     SDL_Scancode toggle_key,
     bool* mounted_flag,
     bool* key_debounce,
@@ -65,7 +66,6 @@ void toggle_mount_with_key(
     float cooldown_duration,
     float dt
 ) {
-    const Uint8* keystate = SDL_GetKeyboardState(NULL);
     *cooldown -= dt;
     if (*cooldown < 0.0f) *cooldown = 0.0f;
 
@@ -37,6 +37,7 @@ void toggle_mount_with_key(
     Entity* child,
     Entity* parent,
     const char* mount_point_name,
+    const Uint8* keystate,
     SDL_Scancode toggle_key,
     bool* mounted_flag,
     bool* toggle_pressed_flag,
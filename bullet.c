@@ -1,98 +1,127 @@
 #include "bullet.h"
+#include "camera.h"
+#include "collision.h"
+#include "command_buffer.h"
+#include "sim_state.h"
 #include <math.h>
 #include <string.h>
 
-Bullet bullets[MAX_BULLETS];
-int bullet_count = 0;
-
 void bullet_system_init() {
-    memset(bullets, 0, sizeof(bullets));
-    bullet_count = 0;
+    sim.bullets.count = 0;
 }
 
-Bullet* spawn_bullet(SDL_Renderer* renderer, float x, float y, float angle, float speed) {
-    // Find free bullet slot
-    int free_slot = -1;
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (!bullets[i].active) {
-            free_slot = i;
-            break;
-        }
+// The entity goes at the next command apply; the bullet slot is free now.
+// If the destroy can't be queued the bullet stays, expired, and
+// update_all_bullets tries again next tick.
+static void kill_bullet(Bullet* b) {
+    if (!command_destroy(sim_entity(b->entity))) {
+        b->lifetime = 0;
+        return;
     }
-    
-    if (free_slot == -1) {
-        return NULL; // No free slots
+    b->entity = -1;
+    b->active = false;
+}
+
+// A dead slot below count, or a new one at the end
+static int free_bullet_slot(void) {
+    for (int i = 0; i < sim.bullets.count; i++) {
+        if (!sim.bullets.items[i].active) return i;
     }
-    
-    // Create bullet entity
-    Entity* bullet_entity = spawn_entity("bullet", renderer, "assets/bullet.png", x, y);
-    if (!bullet_entity) {
-        return NULL;
+    return array_reserve(&sim.bullets, sim.bullets.count + 1) ? sim.bullets.count : -1;
+}
+
+// The shooter itself, or something mounted on it
+static bool is_shooter(const Bullet* b, const Entity* other) {
+    return b->owner >= 0 && (other->slot == b->owner || sim_links(other)->mount_parent == b->owner);
+}
+
+// Runs from dispatch, so the entity goes through the buffer like any other
+// kill. Owning the response also keeps the bullet from shoving its target.
+static void bullet_hit(Entity* self, Entity* other, ContactPhase phase, const CollisionManifold* m) {
+    (void)m;
+    if (phase != CONTACT_ENTER) return;
+    for (int i = 0; i < sim.bullets.count; i++) {
+        Bullet* b = &sim.bullets.items[i];
+        if (!b->active || b->entity != self->slot) continue;
+        if (!is_shooter(b, other)) kill_bullet(b);
+        return;
     }
-    
+}
+
+// Runs during the command apply, so the pools can change here
+static void bullet_spawned(Entity* bullet_entity, Sint16 owner) {
+    int free_slot = free_bullet_slot();
+    if (free_slot == -1) {
+        SDL_Log("Out of memory for a bullet");
+        entity_destroy(bullet_entity);
+        return;
+    }
+
     // Set bullet properties
-    bullet_entity->angle = angle;
-    bullet_entity->speed = speed;
-    bullet_entity->max_speed = speed;
+    bullet_entity->max_speed = bullet_entity->speed;
     bullet_entity->friction = 0; // No friction for bullets
-    bullet_entity->active = true;
     
     // Initialize bullet
-    bullets[free_slot].entity = bullet_entity;
-    bullets[free_slot].lifetime = 3.0f; // 3 seconds lifetime
-    bullets[free_slot].active = true;
+    Bullet* b = &sim.bullets.items[free_slot];
+    b->entity = bullet_entity->slot;
+    b->owner = owner;
+    b->lifetime = 3.0f; // 3 seconds lifetime
+    b->active = true;
     
-    if (free_slot >= bullet_count) {
-        bullet_count = free_slot + 1;
+    if (free_slot >= sim.bullets.count) {
+        sim.bullets.count = free_slot + 1;
     }
-    
-    return &bullets[free_slot];
+
+    ColliderComponent* c = get_collider(bullet_entity);
+    if (c) c->on_contact = bullet_hit;
+}
+
+bool spawn_bullet(const Entity* shooter, float x, float y, float angle, float speed) {
+    return command_spawn("bullet", ENTITY_BULLET, "assets/bullet.png", x, y, angle, speed,
+                         shooter ? shooter->slot : -1, bullet_spawned);
 }
 
 void update_all_bullets(float dt) {
-    for (int i = 0; i < bullet_count; i++) {
-        if (!bullets[i].active) continue;
+    for (int i = 0; i < sim.bullets.count; i++) {
+        Bullet* b = &sim.bullets.items[i];
+        if (!b->active) continue;
         
         // Update lifetime
-        bullets[i].lifetime -= dt;
-        if (bullets[i].lifetime <= 0) {
-            // Properly destroy the entity
-            entity_destroy(bullets[i].entity);
-            bullets[i].entity = NULL;
-            bullets[i].active = false;
+        b->lifetime -= dt;
+        if (b->lifetime <= 0) {
+            kill_bullet(b);
             continue;
         }
         
         // Update bullet physics
-        entity_update(bullets[i].entity, NULL, dt);
+        Entity* e = sim_entity(b->entity);
+        entity_update(e, NULL, dt);
         
-        // Check if bullet is off-screen and destroy it
-        if (bullets[i].entity->x < -50 || bullets[i].entity->x > 1050 ||
-            bullets[i].entity->y < -50 || bullets[i].entity->y > 800) {
-            // Properly destroy the entity
-            entity_destroy(bullets[i].entity);
-            bullets[i].entity = NULL;
-            bullets[i].active = false;
+        // Check if bullet has left the world and destroy it
+        if (!world_contains(e->x, e->y, BULLET_WORLD_MARGIN)) {
+            kill_bullet(b);
         }
     }
 }
 
 void render_all_bullets(SDL_Renderer* renderer) {
-    for (int i = 0; i < bullet_count; i++) {
-        if (bullets[i].active && bullets[i].entity->active) {
-            entity_render(renderer, bullets[i].entity, 
-                         bullets[i].entity->width, bullets[i].entity->height);
+    for (int i = 0; i < sim.bullets.count; i++) {
+        if (!sim.bullets.items[i].active) continue;
+        const Entity* e = sim_entity(sim.bullets.items[i].entity);
+        if (e->active) {
+            entity_render(renderer, e, e->width, e->height);
         }
     }
 }
 
+// Outside the tick, so entities go right away rather than through the buffer
 void cleanup_bullet_system() {
-    for (int i = 0; i < bullet_count; i++) {
-        if (bullets[i].entity) {
-            entity_destroy(bullets[i].entity);
-            bullets[i].entity = NULL;
-        }
-        bullets[i].active = false;
+    for (int i = 0; i < sim.bullets.count; i++) {
+        Bullet* b = &sim.bullets.items[i];
+        if (!b->active) continue;
+        entity_destroy(sim_entity(b->entity));
+        b->entity = -1;
+        b->active = false;
     }
-    bullet_count = 0;
+    sim.bullets.count = 0;
 }
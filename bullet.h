@@ -4,22 +4,23 @@
 #include "entity.h"
 #include <SDL.h>
 
-#define MAX_BULLETS 50
+#define BULLET_WORLD_MARGIN 50.0f  // bullets die this far outside the world
 
+// Lives in SimState (sim.bullets); slots of dead bullets are reused
 typedef struct {
-    Entity* entity;
+    Sint16 entity;      // pool slot
+    Sint16 owner;       // slot of the shooter, never hit; -1 = none
     float lifetime;
     bool active;
 } Bullet;
 
-extern Bullet bullets[MAX_BULLETS];
-extern int bullet_count;
-
 // Initialize bullet system
 void bullet_system_init();
 
-// Spawn a bullet at given position and angle
-Bullet* spawn_bullet(SDL_Renderer* renderer, float x, float y, float angle, float speed);
+// Queue a bullet at given position and angle; it appears at the next
+// command_apply. It ends on the first thing it touches other than the
+// shooter (may be NULL) and what is mounted on it. False if the queue is full.
+bool spawn_bullet(const Entity* shooter, float x, float y, float angle, float speed);
 
 // Update all bullets
 void update_all_bullets(float dt);
@@ -0,0 +1,112 @@
+#include <math.h>
+#include "camera.h"
+
+static WorldBounds world = { 0.0f, 0.0f, 1000.0f, 750.0f };
+static Camera* active_camera = NULL;
+
+void world_set_bounds(float width, float height) {
+    world.min_x = 0.0f;
+    world.min_y = 0.0f;
+    world.max_x = width;
+    world.max_y = height;
+}
+
+WorldBounds world_get_bounds(void) {
+    return world;
+}
+
+bool world_contains(float x, float y, float margin) {
+    return x >= world.min_x - margin && x <= world.max_x + margin &&
+           y >= world.min_y - margin && y <= world.max_y + margin;
+}
+
+void camera_init(Camera* cam, int view_w, int view_h) {
+    cam->view_w = view_w;
+    cam->view_h = view_h;
+    cam->zoom = 1.0f;
+    cam->x = view_w / 2.0f;
+    cam->y = view_h / 2.0f;
+}
+
+void camera_follow(Camera* cam, const Entity* target, float stiffness, float dt) {
+    if (!cam || !target) return;
+
+    // Exponential smoothing; stiffness <= 0 snaps straight to the target
+    float t = (stiffness > 0.0f) ? 1.0f - expf(-stiffness * dt) : 1.0f;
+    cam->x += (target->x - cam->x) * t;
+    cam->y += (target->y - cam->y) * t;
+    camera_clamp_to_world(cam);
+}
+
+void camera_clamp_to_world(Camera* cam) {
+    float half_w = cam->view_w / (2.0f * cam->zoom);
+    float half_h = cam->view_h / (2.0f * cam->zoom);
+
+    // A world smaller than the view stays centered
+    if (world.max_x - world.min_x <= 2.0f * half_w)
+        cam->x = (world.min_x + world.max_x) / 2.0f;
+    else if (cam->x - half_w < world.min_x)
+        cam->x = world.min_x + half_w;
+    else if (cam->x + half_w > world.max_x)
+        cam->x = world.max_x - half_w;
+
+    if (world.max_y - world.min_y <= 2.0f * half_h)
+        cam->y = (world.min_y + world.max_y) / 2.0f;
+    else if (cam->y - half_h < world.min_y)
+        cam->y = world.min_y + half_h;
+    else if (cam->y + half_h > world.max_y)
+        cam->y = world.max_y - half_h;
+}
+
+void camera_set_active(Camera* cam) {
+    active_camera = cam;
+}
+
+Camera* camera_get_active(void) {
+    return active_camera;
+}
+
+bool camera_is_visible_rect(float min_x, float min_y, float max_x, float max_y) {
+    const Camera* cam = active_camera;
+    if (!cam) return true;
+
+    float half_w = cam->view_w / (2.0f * cam->zoom);
+    float half_h = cam->view_h / (2.0f * cam->zoom);
+    return max_x >= cam->x - half_w && min_x <= cam->x + half_w &&
+           max_y >= cam->y - half_h && min_y <= cam->y + half_h;
+}
+
+bool camera_is_visible_circle(float x, float y, float radius) {
+    return camera_is_visible_rect(x - radius, y - radius, x + radius, y + radius);
+}
+
+bool camera_is_entity_visible(const Entity* e, int width, int height) {
+    // Half diagonal bounds the sprite at any rotation
+    float radius = 0.5f * sqrtf((float)(width * width + height * height));
+    return camera_is_visible_circle(e->x, e->y, radius);
+}
+
+void camera_world_to_screen(float wx, float wy, int* sx, int* sy) {
+    const Camera* cam = active_camera;
+    if (!cam) {
+        *sx = (int)wx;
+        *sy = (int)wy;
+        return;
+    }
+    *sx = (int)((wx - cam->x) * cam->zoom + cam->view_w / 2.0f);
+    *sy = (int)((wy - cam->y) * cam->zoom + cam->view_h / 2.0f);
+}
+
+SDL_Rect camera_project_rect(float cx, float cy, int width, int height) {
+    const Camera* cam = active_camera;
+    float zoom = cam ? cam->zoom : 1.0f;
+
+    float w = width * zoom;
+    float h = height * zoom;
+    int sx, sy;
+    camera_world_to_screen(cx, cy, &sx, &sy);
+
+    // Convert center position to top-left for SDL rendering
+    SDL_Rect dst = { (int)(sx - w / 2.0f), (int)(sy - h / 2.0f), (int)w, (int)h };
+    return dst;
+}
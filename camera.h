@@ -0,0 +1,41 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+typedef struct {
+    float x, y;          // world position shown at the center of the view
+    float zoom;          // screen pixels per world unit
+    int view_w, view_h;  // output size in pixels
+} Camera;
+
+typedef struct {
+    float min_x, min_y;
+    float max_x, max_y;
+} WorldBounds;
+
+// World extents; everything outside is off the map
+void        world_set_bounds(float width, float height);
+WorldBounds world_get_bounds(void);
+bool        world_contains(float x, float y, float margin);
+
+void camera_init(Camera* cam, int view_w, int view_h);
+void camera_follow(Camera* cam, const Entity* target, float stiffness, float dt);
+void camera_clamp_to_world(Camera* cam);
+
+// Render paths project through the active camera; NULL means screen == world
+void    camera_set_active(Camera* cam);
+Camera* camera_get_active(void);
+
+// Visibility tests against the active camera, done before any SDL call
+bool camera_is_visible_circle(float x, float y, float radius);
+bool camera_is_visible_rect(float min_x, float min_y, float max_x, float max_y);
+bool camera_is_entity_visible(const Entity* e, int width, int height);
+
+// World -> screen through the active camera
+void     camera_world_to_screen(float wx, float wy, int* sx, int* sy);
+SDL_Rect camera_project_rect(float cx, float cy, int width, int height);
+
+#endif
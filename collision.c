@@ -1,33 +1,130 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <cjson/cJSON.h>
 #include <math.h>
+#include <stdint.h>
 #include <SDL.h>
 #include "entity.h"
 #include "collision.h"
+#include "hitbox_loader.h"
+#include "camera.h"
+#include "dirty_rects.h"
+#include "sim_state.h"
 
-#define MAX_COLLIDERS 128
-static ColliderComponent collider_registry[MAX_COLLIDERS];
-static int collider_count = 0;
+static void forget_pairs(int slot);
 
-void attach_polygon_collider(Entity* e, SDL_Point* points, int point_count) {
-    if (collider_count >= MAX_COLLIDERS) return;
+#if defined(__GNUC__) || defined(__clang__)
+typedef float v4f __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+#define COLLISION_SIMD 1
 
-    ColliderComponent* c = &collider_registry[collider_count++];
-    c->entity = e;
+static inline v4f v4_max(v4f a, v4f b) {
+    v4i m = a > b;
+    return (v4f)(((v4i)a & m) | ((v4i)b & ~m));
+}
+#endif
+
+// Growing may move the colliders: code walking them attaches through command_buffer.h.
+// An entity has at most one; attaching again replaces it.
+static ColliderComponent* new_collider(Entity* e) {
+    if (sim_links(e)->collider >= 0) {
+        forget_pairs(e->slot);
+        return &sim.colliders.items[sim_links(e)->collider];
+    }
+    if (!array_reserve(&sim.colliders, sim.colliders.count + 1)) {
+        SDL_Log("Out of memory for a collider on %s", entity_cold(e)->id ? entity_cold(e)->id : "?");
+        return NULL;
+    }
+    sim_links(e)->collider = sim.colliders.count;
+    return &sim.colliders.items[sim.colliders.count++];
+}
+
+// points must outlive the collider; registry geometry is shared by every instance
+void attach_polygon_collider(Entity* e, const SDL_Point* points, int point_count) {
+    ColliderComponent* c = new_collider(e);
+    if (!c) return;
+    c->entity = e->slot;
     c->type = COLLIDER_POLYGON;
     c->polygon.points = points;
     c->polygon.point_count = point_count;
-    c->on_collision = NULL;  // Optional: you can assign later
+    c->on_contact = NULL;  // Optional: you can assign later
+    collision_default_filter(entity_cold(e)->type, &c->layer, &c->mask);
 }
 
-ColliderComponent* get_collider(Entity* e) {
-    for (int i = 0; i < collider_count; i++) {
-        if (collider_registry[i].entity == e)
-            return &collider_registry[i];
+// x, y in image pixels (top-left origin) like polygon points
+void attach_circle_collider(Entity* e, float x, float y, float radius) {
+    ColliderComponent* c = new_collider(e);
+    if (!c) return;
+    c->entity = e->slot;
+    c->type = COLLIDER_CIRCLE;
+    c->polygon.points = NULL;
+    c->polygon.point_count = 0;
+    c->circle.x = x;
+    c->circle.y = y;
+    c->circle.radius = radius;
+    c->on_contact = NULL;
+    collision_default_filter(entity_cold(e)->type, &c->layer, &c->mask);
+}
+
+void collision_default_filter(EntityType type, Uint32* layer, Uint32* mask) {
+    switch (type) {
+    case ENTITY_ANIMATED:   // flames and burners are visual only
+        *layer = COLLISION_LAYER_EFFECT;
+        *mask = 0;
+        break;
+    case ENTITY_BULLET:     // bullets never hit each other
+        *layer = COLLISION_LAYER_BULLET;
+        *mask = COLLISION_LAYER_VEHICLE | COLLISION_LAYER_SCENERY;
+        break;
+    default:
+        *layer = COLLISION_LAYER_VEHICLE;
+        *mask = COLLISION_LAYER_VEHICLE | COLLISION_LAYER_BULLET | COLLISION_LAYER_SCENERY;
+        break;
     }
-    return NULL;
+}
+
+Uint32 collision_layer_from_name(const char* name) {
+    if (strcmp(name, "vehicle") == 0) return COLLISION_LAYER_VEHICLE;
+    if (strcmp(name, "effect") == 0) return COLLISION_LAYER_EFFECT;
+    if (strcmp(name, "bullet") == 0) return COLLISION_LAYER_BULLET;
+    if (strcmp(name, "scenery") == 0) return COLLISION_LAYER_SCENERY;
+    return 0;
+}
+
+void collider_set_filter(Entity* e, Uint32 layer, Uint32 mask) {
+    ColliderComponent* c = get_collider(e);
+    if (!c) return;
+    c->layer = layer;
+    c->mask = mask;
+}
+
+// A mount never collides with its parent or with siblings on the same parent
+static bool same_mount_family(int a, int b) {
+    int pa = sim_link(a)->mount_parent;
+    int pb = sim_link(b)->mount_parent;
+    return pa == b || pb == a || (pa >= 0 && pa == pb);
+}
+
+// Runs before any transform or SAT work
+static bool pair_filtered_out(const ColliderComponent* c1, const ColliderComponent* c2) {
+    if (!(c1->layer & c2->mask) || !(c2->layer & c1->mask)) return true;
+    return same_mount_family(c1->entity, c2->entity);
+}
+
+// The last collider moves into the hole; its link follows
+void detach_collider(Entity* e) {
+    EntityLinks* links = sim_links(e);
+    int i = links->collider;
+    if (i < 0) return;
+    forget_pairs(e->slot);
+    sim.colliders.items[i] = sim.colliders.items[--sim.colliders.count];
+    if (i < sim.colliders.count) sim_link(sim.colliders.items[i].entity)->collider = i;
+    links->collider = -1;
+}
+
+ColliderComponent* get_collider(Entity* e) {
+    int i = sim_links(e)->collider;
+    return i >= 0 ? &sim.colliders.items[i] : NULL;
 }
 
 void load_entity_hitbox(Entity* e, const char* image_filename) {
@@ -38,49 +135,13 @@ void load_entity_hitbox(Entity* e, const char* image_filename) {
     if (ext) strcpy(ext, ".json");
     else strcat(json_filename, ".json");
 
-    FILE* f = fopen(json_filename, "rb");
-    if (!f) return;
-
-    fseek(f, 0, SEEK_END);
-    long len = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    char* data = malloc(len + 1);
-    fread(data, 1, len, f);
-    data[len] = '\0';
-    fclose(f);
-
-    cJSON* root = cJSON_Parse(data);
-    free(data);
-    if (!root) return;
-
-    cJSON* shapes = cJSON_GetObjectItem(root, "shapes");
-    int shape_count = cJSON_GetArraySize(shapes);
-
-    for (int i = 0; i < shape_count; i++) {
-        cJSON* shape = cJSON_GetArrayItem(shapes, i);
-        const char* label = cJSON_GetObjectItem(shape, "label")->valuestring;
-
-        if (strcmp(label, e->id) != 0) continue;
+    HitboxFile hf;
+    if (!hitbox_file_parse(json_filename, &hf)) return;
+    hitbox_registry_add_file(&hf);
+    hitbox_file_free(&hf);
 
-        const char* shape_type = cJSON_GetObjectItem(shape, "shape_type")->valuestring;
-        if (strcmp(shape_type, "polygon") != 0) continue;
-
-	cJSON* points = cJSON_GetObjectItem(shape, "points");
-        int count = cJSON_GetArraySize(points);
-        if (count < 3) continue;
-
-        SDL_Point* poly = malloc(sizeof(SDL_Point) * count);
-        for (int j = 0; j < count; j++) {
-            cJSON* pt = cJSON_GetArrayItem(points, j);
-            poly[j].x = (int)cJSON_GetArrayItem(pt, 0)->valuedouble;
-            poly[j].y = (int)cJSON_GetArrayItem(pt, 1)->valuedouble;
-        }
-
-        attach_polygon_collider(e, poly, count);
-        break;  // Only first matching shape is attached
-    }
-
-    cJSON_Delete(root);
+    if (!get_collider(e))
+        hitbox_registry_attach(e);
 }
 
 SDL_Point rotate_and_translate(SDL_Point p, float angle, float cx, float cy) {
@@ -103,97 +164,329 @@ SDL_Point rotate_and_translate(SDL_Point p, float angle, float cx, float cy) {
     return result;
 }
 
-bool polygons_intersect(SDL_Point* poly1, int count1, SDL_Point* poly2, int count2) {
-    // Check all edges of poly1
-    for (int i = 0; i < count1; i++) {
-        int j = (i + 1) % count1;
-        
-        // Get edge vector
-        float edge_x = poly1[j].x - poly1[i].x;
-        float edge_y = poly1[j].y - poly1[i].y;
-        
-        // Get perpendicular (normal) vector
-        float normal_x = -edge_y;
-        float normal_y = edge_x;
-        
-        // Normalize
+static void project_polygon(const SDL_Point* poly, int count, float ax, float ay, float* out_min, float* out_max) {
+    float lo = FLT_MAX, hi = -FLT_MAX;
+    for (int k = 0; k < count; k++) {
+        float dot = poly[k].x * ax + poly[k].y * ay;
+        if (dot < lo) lo = dot;
+        if (dot > hi) hi = dot;
+    }
+    *out_min = lo;
+    *out_max = hi;
+}
+
+static bool axis_separates(const SDL_Point* poly1, int count1, const SDL_Point* poly2, int count2,
+                           float ax, float ay) {
+    float min1, max1, min2, max2;
+    project_polygon(poly1, count1, ax, ay, &min1, &max1);
+    project_polygon(poly2, count2, ax, ay, &min2, &max2);
+    return max1 < min2 || max2 < min1;
+}
+
+// Test the edge normals of `edges`; false as soon as one separates the
+// polygons (stored in sep if given), otherwise keeps the axis of least
+// overlap in best
+static bool sat_edge_axes(const SDL_Point* edges, int edge_count,
+                          const SDL_Point* poly1, int count1,
+                          const SDL_Point* poly2, int count2,
+                          CollisionManifold* best, SatAxis* sep) {
+    for (int i = 0; i < edge_count; i++) {
+        int j = (i + 1) % edge_count;
+
+        // Perpendicular of the edge, normalized
+        float normal_x = -(float)(edges[j].y - edges[i].y);
+        float normal_y = (float)(edges[j].x - edges[i].x);
         float length = sqrtf(normal_x * normal_x + normal_y * normal_y);
-        if (length > 0) {
-            normal_x /= length;
-            normal_y /= length;
-        }
-        
-        // Project both polygons onto this axis
-        float min1 = FLT_MAX, max1 = -FLT_MAX;
-        float min2 = FLT_MAX, max2 = -FLT_MAX;
-        
-        for (int k = 0; k < count1; k++) {
-            float dot = poly1[k].x * normal_x + poly1[k].y * normal_y;
-            if (dot < min1) min1 = dot;
-            if (dot > max1) max1 = dot;
-        }
-        
-        for (int k = 0; k < count2; k++) {
-            float dot = poly2[k].x * normal_x + poly2[k].y * normal_y;
-            if (dot < min2) min2 = dot;
-            if (dot > max2) max2 = dot;
-        }
-        
-        // Check for separation
+        if (length == 0) continue;
+        normal_x /= length;
+        normal_y /= length;
+
+        float min1, max1, min2, max2;
+        project_polygon(poly1, count1, normal_x, normal_y, &min1, &max1);
+        project_polygon(poly2, count2, normal_x, normal_y, &min2, &max2);
+
         if (max1 < min2 || max2 < min1) {
+            if (sep) *sep = (SatAxis){ normal_x, normal_y, true };
             return false; // Separating axis found
         }
+
+        float overlap = fminf(max1, max2) - fmaxf(min1, min2);
+        if (overlap < best->depth) {
+            best->depth = overlap;
+            best->normal_x = normal_x;
+            best->normal_y = normal_y;
+        }
     }
-    
-    // Check all edges of poly2
-    for (int i = 0; i < count2; i++) {
-        int j = (i + 1) % count2;
-        
-        float edge_x = poly2[j].x - poly2[i].x;
-        float edge_y = poly2[j].y - poly2[i].y;
-        
-        float normal_x = -edge_y;
-        float normal_y = edge_x;
-        
+    return true;
+}
+
+static void polygon_centroid(const SDL_Point* poly, int count, float* cx, float* cy) {
+    float sx = 0, sy = 0;
+    for (int i = 0; i < count; i++) {
+        sx += poly[i].x;
+        sy += poly[i].y;
+    }
+    *cx = sx / count;
+    *cy = sy / count;
+}
+
+// SAT with temporal coherence: the axis that separated the pair last time
+// usually still does, so try it before walking every edge
+static bool polygons_sat(const SDL_Point* poly1, int count1, const SDL_Point* poly2, int count2,
+                         SatAxis* hint, CollisionManifold* out) {
+    if (count1 < 2 || count2 < 2) return false;
+
+    if (hint && hint->valid && axis_separates(poly1, count1, poly2, count2, hint->x, hint->y))
+        return false;
+
+    CollisionManifold best = { 0.0f, 0.0f, FLT_MAX };
+    if (!sat_edge_axes(poly1, count1, poly1, count1, poly2, count2, &best, hint)) return false;
+    if (!sat_edge_axes(poly2, count2, poly1, count1, poly2, count2, &best, hint)) return false;
+    if (hint) hint->valid = false;
+
+    // Orient the normal from the first polygon toward the second
+    float c1x, c1y, c2x, c2y;
+    polygon_centroid(poly1, count1, &c1x, &c1y);
+    polygon_centroid(poly2, count2, &c2x, &c2y);
+    if ((c2x - c1x) * best.normal_x + (c2y - c1y) * best.normal_y < 0) {
+        best.normal_x = -best.normal_x;
+        best.normal_y = -best.normal_y;
+    }
+
+    if (out) *out = best;
+    return true; // No separating axis found, polygons intersect
+}
+
+bool circles_intersect_mtv(float ax, float ay, float ar, float bx, float by, float br,
+                           CollisionManifold* out) {
+    float dx = bx - ax, dy = by - ay;
+    float reach = ar + br;
+    float dist2 = dx * dx + dy * dy;
+    if (dist2 > reach * reach) return false;
+
+    if (out) {
+        float dist = sqrtf(dist2);
+        out->normal_x = dist > 0 ? dx / dist : 1.0f;   // concentric: any axis will do
+        out->normal_y = dist > 0 ? dy / dist : 0.0f;
+        out->depth = reach - dist;
+    }
+    return true;
+}
+
+// Overlap of the polygon and the circle on one axis, kept in best if least
+static bool circle_axis_overlaps(const SDL_Point* poly, int count, float cx, float cy, float r,
+                                 float ax, float ay, CollisionManifold* best) {
+    float min1, max1;
+    project_polygon(poly, count, ax, ay, &min1, &max1);
+    float center = cx * ax + cy * ay;
+    float min2 = center - r, max2 = center + r;
+    if (max1 < min2 || max2 < min1) return false;
+
+    float overlap = fminf(max1, max2) - fmaxf(min1, min2);
+    if (overlap < best->depth) {
+        best->depth = overlap;
+        best->normal_x = ax;
+        best->normal_y = ay;
+    }
+    return true;
+}
+
+// SAT against a circle: the edge normals, plus the axis from the nearest
+// vertex to the center for the corner regions. Normal from polygon to circle.
+static bool polygon_circle_sat(const SDL_Point* poly, int count, float cx, float cy, float r,
+                               SatAxis* hint, CollisionManifold* out) {
+    if (count < 2) return false;
+
+    CollisionManifold best = { 0.0f, 0.0f, FLT_MAX };
+    if (hint && hint->valid && !circle_axis_overlaps(poly, count, cx, cy, r, hint->x, hint->y, &best))
+        return false;
+
+    best = (CollisionManifold){ 0.0f, 0.0f, FLT_MAX };
+    float nearest = FLT_MAX;
+    int nearest_i = 0;
+    for (int i = 0; i < count; i++) {
+        int j = (i + 1) % count;
+        float dx = cx - poly[i].x, dy = cy - poly[i].y;
+        if (dx * dx + dy * dy < nearest) {
+            nearest = dx * dx + dy * dy;
+            nearest_i = i;
+        }
+
+        float normal_x = -(float)(poly[j].y - poly[i].y);
+        float normal_y = (float)(poly[j].x - poly[i].x);
         float length = sqrtf(normal_x * normal_x + normal_y * normal_y);
-        if (length > 0) {
-            normal_x /= length;
-            normal_y /= length;
+        if (length == 0) continue;
+        normal_x /= length;
+        normal_y /= length;
+        if (!circle_axis_overlaps(poly, count, cx, cy, r, normal_x, normal_y, &best)) {
+            if (hint) *hint = (SatAxis){ normal_x, normal_y, true };
+            return false;
         }
-        
-        float min1 = FLT_MAX, max1 = -FLT_MAX;
-        float min2 = FLT_MAX, max2 = -FLT_MAX;
-        
-        for (int k = 0; k < count1; k++) {
-            float dot = poly1[k].x * normal_x + poly1[k].y * normal_y;
-            if (dot < min1) min1 = dot;
-            if (dot > max1) max1 = dot;
+    }
+
+    float length = sqrtf(nearest);
+    if (length > 0) {
+        float ax = (cx - poly[nearest_i].x) / length, ay = (cy - poly[nearest_i].y) / length;
+        if (!circle_axis_overlaps(poly, count, cx, cy, r, ax, ay, &best)) {
+            if (hint) *hint = (SatAxis){ ax, ay, true };
+            return false;
         }
-        
-        for (int k = 0; k < count2; k++) {
-            float dot = poly2[k].x * normal_x + poly2[k].y * normal_y;
-            if (dot < min2) min2 = dot;
-            if (dot > max2) max2 = dot;
+    }
+    if (hint) hint->valid = false;
+
+    float px, py;
+    polygon_centroid(poly, count, &px, &py);
+    if ((cx - px) * best.normal_x + (cy - py) * best.normal_y < 0) {
+        best.normal_x = -best.normal_x;
+        best.normal_y = -best.normal_y;
+    }
+
+    if (out) *out = best;
+    return true;
+}
+
+bool polygon_circle_intersect_mtv(const SDL_Point* poly, int count, float cx, float cy, float r,
+                                  CollisionManifold* out) {
+    return polygon_circle_sat(poly, count, cx, cy, r, NULL, out);
+}
+
+static float hull_cross(SDL_Point o, SDL_Point a, SDL_Point b) {
+    return (float)(a.x - o.x) * (float)(b.y - o.y) - (float)(a.y - o.y) * (float)(b.x - o.x);
+}
+
+// Monotone chain hull, then one outward half-plane per hull edge
+bool convex_half_planes(const SDL_Point* poly, int count, ConvexHalfPlanes* out) {
+    if (count < 3 || count > COLLISION_STACK_POINTS) return false;
+
+    // Insertion sort by x then y; outlines are short
+    SDL_Point sorted[COLLISION_STACK_POINTS];
+    for (int i = 0; i < count; i++) {
+        SDL_Point p = poly[i];
+        int j = i;
+        while (j > 0 && (sorted[j - 1].x > p.x || (sorted[j - 1].x == p.x && sorted[j - 1].y > p.y))) {
+            sorted[j] = sorted[j - 1];
+            j--;
         }
-        
-        if (max1 < min2 || max2 < min1) {
-            return false;
+        sorted[j] = p;
+    }
+
+    SDL_Point hull[2 * COLLISION_STACK_POINTS];
+    int k = 0;
+    for (int i = 0; i < count; i++) {
+        while (k >= 2 && hull_cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) k--;
+        hull[k++] = sorted[i];
+    }
+    for (int i = count - 2, lower = k + 1; i >= 0; i--) {
+        while (k >= lower && hull_cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) k--;
+        hull[k++] = sorted[i];
+    }
+    k--;    // the last point repeats the first
+    if (k < 3) return false;
+
+    // Counter-clockwise in x/y, so (ey, -ex) points out
+    out->count = 0;
+    for (int i = 0; i < k; i++) {
+        float ex = (float)(hull[i + 1].x - hull[i].x);
+        float ey = (float)(hull[i + 1].y - hull[i].y);
+        float length = sqrtf(ex * ex + ey * ey);
+        float nx = ey / length, ny = -ex / length;
+        out->nx[out->count] = nx;
+        out->ny[out->count] = ny;
+        out->d[out->count] = nx * hull[i].x + ny * hull[i].y;
+        out->count++;
+    }
+    return true;
+}
+
+// A circle misses when its center is more than r outside any one edge line.
+// The SAT counts touching as a hit, so allow for rounding in d.
+#define HALF_PLANE_EPSILON 1e-3f
+
+int circles_vs_half_planes(const ConvexHalfPlanes* hp, const float* x, const float* y, const float* r,
+                           int count, Uint8* hits) {
+    int total = 0;
+    int i = 0;
+#ifdef COLLISION_SIMD
+    for (; i + 4 <= count; i += 4) {
+        v4f px, py, pr;
+        memcpy(&px, x + i, sizeof(v4f));
+        memcpy(&py, y + i, sizeof(v4f));
+        memcpy(&pr, r + i, sizeof(v4f));
+
+        // Largest signed distance past any edge, less the radius
+        v4f outside = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (int k = 0; k < hp->count; k++) {
+            v4f nx = { hp->nx[k], hp->nx[k], hp->nx[k], hp->nx[k] };
+            v4f ny = { hp->ny[k], hp->ny[k], hp->ny[k], hp->ny[k] };
+            v4f d = { hp->d[k], hp->d[k], hp->d[k], hp->d[k] };
+            outside = v4_max(outside, px * nx + py * ny - d);
+        }
+        v4i hit = (outside - pr) <= HALF_PLANE_EPSILON;
+        for (int l = 0; l < 4; l++) {
+            hits[i + l] = hit[l] != 0;
+            total += hits[i + l];
         }
     }
-    
-    return true; // No separating axis found, polygons intersect
+#endif
+    for (; i < count; i++) {
+        float outside = -FLT_MAX;
+        for (int k = 0; k < hp->count; k++)
+            outside = fmaxf(outside, x[i] * hp->nx[k] + y[i] * hp->ny[k] - hp->d[k]);
+        hits[i] = outside - r[i] <= HALF_PLANE_EPSILON;
+        total += hits[i];
+    }
+    return total;
+}
+
+bool polygons_intersect_mtv(const SDL_Point* poly1, int count1, const SDL_Point* poly2, int count2,
+                            CollisionManifold* out) {
+    return polygons_sat(poly1, count1, poly2, count2, NULL, out);
+}
+
+bool polygons_intersect(SDL_Point* poly1, int count1, SDL_Point* poly2, int count2) {
+    return polygons_intersect_mtv(poly1, count1, poly2, count2, NULL);
+}
+
+bool polygon_contains_point(const SDL_Point* poly, int count, float x, float y) {
+    bool inside = false;
+    for (int i = 0, j = count - 1; i < count; j = i++) {
+        float xi = poly[i].x, yi = poly[i].y, xj = poly[j].x, yj = poly[j].y;
+        if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+            inside = !inside;
+    }
+    return inside;
+}
+
+float polygon_point_distance(const SDL_Point* poly, int count, float x, float y) {
+    if (polygon_contains_point(poly, count, x, y)) return 0.0f;
+
+    float best = FLT_MAX;
+    for (int i = 0, j = count - 1; i < count; j = i++) {
+        float ax = poly[j].x, ay = poly[j].y;
+        float ex = poly[i].x - ax, ey = poly[i].y - ay;
+        float len2 = ex * ex + ey * ey;
+        float t = len2 > 0 ? ((x - ax) * ex + (y - ay) * ey) / len2 : 0.0f;
+        t = fmaxf(0.0f, fminf(1.0f, t));
+        float dx = ax + t * ex - x, dy = ay + t * ey - y;
+        best = fminf(best, dx * dx + dy * dy);
+    }
+    return sqrtf(best);
 }
 
 // Debug function to print entity and polygon info
 void debug_collision_info(Entity* entity) {
     ColliderComponent* c = get_collider(entity);
     if (!c) {
-        printf("No collider for entity %s\n", entity->id);
+        printf("No collider for entity %s\n", entity_cold(entity)->id);
         return;
     }
     
     printf("Entity %s: pos(%.1f, %.1f) angle(%.1f)\n", 
-           entity->id, entity->x, entity->y, entity->angle);
+           entity_cold(entity)->id, entity->x, entity->y, entity->angle);
+    if (c->type == COLLIDER_CIRCLE) {
+        printf("  Circle center (%.1f,%.1f) radius %.1f\n", c->circle.x, c->circle.y, c->circle.radius);
+        return;
+    }
     printf("  Polygon points (%d): ", c->polygon.point_count);
     for (int i = 0; i < c->polygon.point_count; i++) {
         printf("(%.1f,%.1f) ", (float)c->polygon.points[i].x, (float)c->polygon.points[i].y);
@@ -202,10 +495,9 @@ void debug_collision_info(Entity* entity) {
 }
 
 // Transform polygon points to world coordinates
-void transform_polygon(SDL_Point* src, SDL_Point* dest, int count, Entity* entity) {
-    float angle_rad = entity->angle * M_PI / 180.0f;
-    float cos_a = cosf(angle_rad);
-    float sin_a = sinf(angle_rad);
+void transform_polygon(const SDL_Point* src, SDL_Point* dest, int count, Entity* entity) {
+    float cos_a, sin_a;
+    entity_heading(entity, &cos_a, &sin_a);
     float half_width, half_height;
     
     half_width = entity->width / 2.0f;
@@ -226,51 +518,18 @@ void transform_polygon(SDL_Point* src, SDL_Point* dest, int count, Entity* entit
     }
 }
 
-// Check collision between two entities using their polygon colliders
-bool check_entities_collision(Entity* e1, Entity* e2) {
-    ColliderComponent* c1 = get_collider(e1);
-    ColliderComponent* c2 = get_collider(e2);
-    
-    if (!c1 || !c2) return false;
-    if (c1->type != COLLIDER_POLYGON || c2->type != COLLIDER_POLYGON) return false;
-    
-    // Transform polygons to world coordinates
-    SDL_Point* poly1 = malloc(sizeof(SDL_Point) * c1->polygon.point_count);
-    SDL_Point* poly2 = malloc(sizeof(SDL_Point) * c2->polygon.point_count);
-    
-    transform_polygon(c1->polygon.points, poly1, c1->polygon.point_count, e1);
-    transform_polygon(c2->polygon.points, poly2, c2->polygon.point_count, e2);
-    
-    bool collision = polygons_intersect(poly1, c1->polygon.point_count, 
-                                       poly2, c2->polygon.point_count);
-    
-    free(poly1);
-    free(poly2);
-    
-    return collision;
+// World position of a circle collider's center, not rounded to pixels
+void collider_circle_center(const ColliderComponent* c, const Entity* e, float* x, float* y) {
+    float cos_a, sin_a;
+    entity_heading(e, &cos_a, &sin_a);
+    float local_x = c->circle.x - e->width / 2.0f;
+    float local_y = c->circle.y - e->height / 2.0f;
+    *x = local_x * cos_a - local_y * sin_a + e->x;
+    *y = local_x * sin_a + local_y * cos_a + e->y;
 }
 
-// Handle all collisions in the system
-void handle_all_collisions(float dt) {
-    (void)dt; // Suppress unused parameter warning
-    
-    for (int i = 0; i < collider_count; i++) {
-        for (int j = i + 1; j < collider_count; j++) {
-            ColliderComponent* c1 = &collider_registry[i];
-            ColliderComponent* c2 = &collider_registry[j];
-            
-            if (check_entities_collision(c1->entity, c2->entity)) {
-                // Call collision callbacks if they exist
-                if (c1->on_collision) {
-                    c1->on_collision(c1->entity, c2->entity);
-                }
-                if (c2->on_collision) {
-                    c2->on_collision(c2->entity, c1->entity);
-                }
-            }
-        }
-    }
-}
+// A circle outline only depends on its screen rect
+static const char circle_outline_key;
 
 // Draw collision polygons for debugging
 void draw_all_collision_polygons(SDL_Renderer* renderer, Entity** entities, int count) {
@@ -278,15 +537,39 @@ void draw_all_collision_polygons(SDL_Renderer* renderer, Entity** entities, int
     
     for (int i = 0; i < count; i++) {
         ColliderComponent* c = get_collider(entities[i]);
-        if (!c || c->type != COLLIDER_POLYGON) continue;
+        if (!c) continue;
+        if (!entities[i]->active) continue;
+        if (!camera_is_entity_visible(entities[i], entities[i]->width, entities[i]->height)) continue;
         
-        // Transform to world coordinates
-        SDL_Point* world_poly = malloc(sizeof(SDL_Point) * c->polygon.point_count);
-        transform_polygon(c->polygon.points, world_poly, c->polygon.point_count, entities[i]);
+        // Transform to world coordinates, then through the camera
+        bool circle = c->type == COLLIDER_CIRCLE;
+        int point_count = circle ? COLLISION_CIRCLE_SEGMENTS : c->polygon.point_count;
+        SDL_Point* world_poly = malloc(sizeof(SDL_Point) * point_count);
+        if (!world_poly) continue;
+        if (circle) {
+            float cx, cy;
+            collider_circle_center(c, entities[i], &cx, &cy);
+            for (int j = 0; j < point_count; j++) {
+                float a = 6.2831853f * j / point_count;
+                world_poly[j].x = (int)(cx + c->circle.radius * cosf(a));
+                world_poly[j].y = (int)(cy + c->circle.radius * sinf(a));
+            }
+        } else {
+            transform_polygon(c->polygon.points, world_poly, point_count, entities[i]);
+        }
+        for (int j = 0; j < point_count; j++)
+            camera_world_to_screen(world_poly[j].x, world_poly[j].y, &world_poly[j].x, &world_poly[j].y);
+
+        SDL_Rect bounds;
+        SDL_EnclosePoints(world_poly, point_count, NULL, &bounds);
+        if (!dirty_rects_submit(&bounds, circle ? (const void*)&circle_outline_key : c->polygon.points, 0.0f)) {
+            free(world_poly);
+            continue;
+        }
         
         // Draw polygon edges
-        for (int j = 0; j < c->polygon.point_count; j++) {
-            int next = (j + 1) % c->polygon.point_count;
+        for (int j = 0; j < point_count; j++) {
+            int next = (j + 1) % point_count;
             SDL_RenderDrawLine(renderer, 
                              world_poly[j].x, world_poly[j].y,
                              world_poly[next].x, world_poly[next].y);
@@ -296,3 +579,480 @@ void draw_all_collision_polygons(SDL_Renderer* renderer, Entity** entities, int
     }
 }
 
+// Enclosing circle: the collider itself, or the sprite, which bounds its hitbox
+static void collider_bounds(const ColliderComponent* c, float* x, float* y, float* r) {
+    const Entity* e = sim_entity(c->entity);
+    if (c->type == COLLIDER_CIRCLE) {
+        collider_circle_center(c, e, x, y);
+        *r = c->circle.radius;
+        return;
+    }
+    *x = e->x;
+    *y = e->y;
+    *r = 0.5f * sqrtf((float)(e->width * e->width + e->height * e->height));
+}
+
+// Cheap reject: compare enclosing circles
+static bool bounds_overlap(const ColliderComponent* a, const ColliderComponent* b) {
+    float ax, ay, ra, bx, by, rb;
+    collider_bounds(a, &ax, &ay, &ra);
+    collider_bounds(b, &bx, &by, &rb);
+    float dx = bx - ax;
+    float dy = by - ay;
+    return dx * dx + dy * dy <= (ra + rb) * (ra + rb);
+}
+
+// One polygon and one circle in either order; out still points c1 -> c2
+static bool collide_polygon_circle(const ColliderComponent* c1, const ColliderComponent* c2,
+                                   SatAxis* hint, CollisionManifold* out) {
+    bool circle_first = c1->type == COLLIDER_CIRCLE;
+    const ColliderComponent* pc = circle_first ? c2 : c1;
+    const ColliderComponent* cc = circle_first ? c1 : c2;
+
+    int n = pc->polygon.point_count;
+    SDL_Point stack[COLLISION_STACK_POINTS];
+    SDL_Point* poly = (n <= COLLISION_STACK_POINTS) ? stack : malloc(sizeof(SDL_Point) * n);
+    if (!poly) return false;
+    transform_polygon(pc->polygon.points, poly, n, sim_entity(pc->entity));
+
+    float cx, cy;
+    collider_circle_center(cc, sim_entity(cc->entity), &cx, &cy);
+    bool collision = polygon_circle_sat(poly, n, cx, cy, cc->circle.radius, hint, out);
+    if (collision && circle_first && out) {
+        out->normal_x = -out->normal_x;
+        out->normal_y = -out->normal_y;
+    }
+
+    if (poly != stack) free(poly);
+    return collision;
+}
+
+// Narrowphase for two colliders that passed the filter and bounds tests
+static bool collide_colliders(const ColliderComponent* c1, const ColliderComponent* c2,
+                              SatAxis* hint, CollisionManifold* out) {
+    Entity* e1 = sim_entity(c1->entity);
+    Entity* e2 = sim_entity(c2->entity);
+
+    if (c1->type == COLLIDER_CIRCLE && c2->type == COLLIDER_CIRCLE) {
+        float ax, ay, bx, by;
+        collider_circle_center(c1, e1, &ax, &ay);
+        collider_circle_center(c2, e2, &bx, &by);
+        return circles_intersect_mtv(ax, ay, c1->circle.radius, bx, by, c2->circle.radius, out);
+    }
+    if (c1->type == COLLIDER_CIRCLE || c2->type == COLLIDER_CIRCLE)
+        return collide_polygon_circle(c1, c2, hint, out);
+
+    // Transform polygons to world coordinates, on the stack when they fit
+    int n1 = c1->polygon.point_count;
+    int n2 = c2->polygon.point_count;
+    SDL_Point stack1[COLLISION_STACK_POINTS], stack2[COLLISION_STACK_POINTS];
+    SDL_Point* poly1 = (n1 <= COLLISION_STACK_POINTS) ? stack1 : malloc(sizeof(SDL_Point) * n1);
+    SDL_Point* poly2 = (n2 <= COLLISION_STACK_POINTS) ? stack2 : malloc(sizeof(SDL_Point) * n2);
+    
+    bool collision = false;
+    if (poly1 && poly2) {
+        transform_polygon(c1->polygon.points, poly1, n1, e1);
+        transform_polygon(c2->polygon.points, poly2, n2, e2);
+        collision = polygons_sat(poly1, n1, poly2, n2, hint, out);
+    }
+    
+    if (poly1 != stack1) free(poly1);
+    if (poly2 != stack2) free(poly2);
+    
+    return collision;
+}
+
+bool collide_entities(Entity* e1, Entity* e2, CollisionManifold* out) {
+    ColliderComponent* c1 = get_collider(e1);
+    ColliderComponent* c2 = get_collider(e2);
+    
+    if (!c1 || !c2) return false;
+    if (pair_filtered_out(c1, c2)) return false;
+    if (!bounds_overlap(c1, c2)) return false;
+    return collide_colliders(c1, c2, NULL, out);
+}
+
+// Check collision between two entities using their colliders
+bool check_entities_collision(Entity* e1, Entity* e2) {
+    return collide_entities(e1, e2, NULL);
+}
+
+// Reflect the part of a body's heading velocity that points along n, then
+// project back onto the heading (entities only move forward/backward)
+static float bounce_off(Entity* e, float nx, float ny, float restitution) {
+    float hx, hy;
+    entity_heading(e, &hx, &hy);
+    float vx = hx * e->speed, vy = hy * e->speed;
+
+    float vn = vx * nx + vy * ny;
+    if (vn <= 0) return 0.0f;    // already moving away
+
+    vx -= (1.0f + restitution) * vn * nx;
+    vy -= (1.0f + restitution) * vn * ny;
+    e->speed = vx * hx + vy * hy;
+    return vn;
+}
+
+float resolve_contact(Entity* a, Entity* b, const CollisionManifold* m, float restitution) {
+    bool a_moves = !entity_is_static(a);
+    bool b_moves = !entity_is_static(b);
+    if (!a_moves && !b_moves) return 0.0f;
+
+    // Split the push between movable bodies; one tick is enough to separate
+    float push = m->depth + COLLISION_SLOP;
+    float share_a = a_moves ? (b_moves ? 0.5f : 1.0f) : 0.0f;
+    float share_b = b_moves ? 1.0f - share_a : 0.0f;
+    a->x -= m->normal_x * push * share_a;
+    a->y -= m->normal_y * push * share_a;
+    b->x += m->normal_x * push * share_b;
+    b->y += m->normal_y * push * share_b;
+
+    float impact = 0.0f;
+    if (a_moves) {
+        entity_wake(a);
+        impact = fmaxf(impact, bounce_off(a, m->normal_x, m->normal_y, restitution));
+    }
+    if (b_moves) {
+        entity_wake(b);
+        impact = fmaxf(impact, bounce_off(b, -m->normal_x, -m->normal_y, restitution));
+    }
+    return impact;
+}
+
+// ---- Contact pairs ----
+// The pair table itself is simulation state (sim.pairs); events are
+// produced and consumed within one tick.
+
+static ARRAY(ContactEvent) events;
+
+// What resolve_contact reported per body in the last pass, for effects
+typedef struct {
+    Sint16 slot;
+    float impact;
+} ContactImpact;
+
+static ARRAY(ContactImpact) impacts;
+
+static void record_impact(const Entity* e, float impact) {
+    ContactImpact hit = { e->slot, impact };
+    if (!array_push(&impacts, hit))
+        SDL_Log("Out of memory: impact on slot %d not recorded", e->slot);
+}
+
+float collision_last_impact(const Entity* e) {
+    float hardest = 0.0f;
+    for (int i = 0; i < impacts.count; i++) {
+        if (impacts.items[i].slot == e->slot && impacts.items[i].impact > hardest)
+            hardest = impacts.items[i].impact;
+    }
+    return hardest;
+}
+
+static Uint32 hash_pair(int a, int b) {
+    Uint32 v = (Uint32)a * 0x9E3779B1u ^ (Uint32)b;
+    v ^= v >> 16;
+    v *= 0x85ebca6bu;
+    v ^= v >> 13;
+    return v;
+}
+
+// Slot of the pair, or of the empty slot it would take
+static Uint32 find_pair_slot(int a, int b) {
+    Uint32 mask = (Uint32)sim.pairs.count - 1;
+    ContactPair* pairs = sim.pairs.items;
+    Uint32 i = hash_pair(a, b) & mask;
+    while (pairs[i].used && (pairs[i].a != a || pairs[i].b != b))
+        i = (i + 1) & mask;
+    return i;
+}
+
+// Double the table (or make the first one) and rehash every pair into it
+static bool grow_pairs(void) {
+    int size = sim.pairs.count ? sim.pairs.count * 2 : CONTACT_PAIR_MIN_SLOTS;
+    ContactPair* table = calloc(size, sizeof(ContactPair));
+    if (!table) {
+        SDL_Log("Out of memory for %d contact pairs", size);
+        return false;
+    }
+    ContactPair* old = sim.pairs.items;
+    int old_size = sim.pairs.count;
+    sim.pairs.items = table;
+    sim.pairs.count = sim.pairs.capacity = size;
+    for (int i = 0; i < old_size; i++) {
+        if (old[i].used) table[find_pair_slot(old[i].a, old[i].b)] = old[i];
+    }
+    free(old);
+    return true;
+}
+
+static ContactPair* get_pair(int a, int b) {
+    if (a > b) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    ContactPair* p = sim.pairs.count ? &sim.pairs.items[find_pair_slot(a, b)] : NULL;
+    if (!p || !p->used) {
+        // A new pair: at half load the table doubles first, keeping probes short
+        if (2 * (sim.pair_count + 1) > sim.pairs.count) {
+            if (!grow_pairs()) return NULL;
+            p = &sim.pairs.items[find_pair_slot(a, b)];
+        }
+        memset(p, 0, sizeof(ContactPair));
+        p->used = true;
+        p->a = (Sint16)a;
+        p->b = (Sint16)b;
+        sim.pair_count++;
+    }
+    return p;
+}
+
+// Backward-shift delete keeps linear probing chains intact without tombstones
+static void remove_pair_at(Uint32 hole) {
+    Uint32 mask = (Uint32)sim.pairs.count - 1;
+    ContactPair* pairs = sim.pairs.items;
+    pairs[hole].used = false;
+    for (Uint32 j = (hole + 1) & mask; pairs[j].used; j = (j + 1) & mask) {
+        Uint32 home = hash_pair(pairs[j].a, pairs[j].b) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            pairs[hole] = pairs[j];
+            pairs[j].used = false;
+            hole = j;
+        }
+    }
+    sim.pair_count--;
+}
+
+static void push_event(ContactPair* p, ContactPhase phase) {
+    ContactEvent ev = { sim_entity(p->a), sim_entity(p->b), phase, p->manifold };
+    if (!array_push(&events, ev))
+        SDL_Log("Out of memory: contact event between slots %d and %d dropped", p->a, p->b);
+}
+
+// Drop every pair involving the slot; no exit event, the entity is going away
+static void forget_pairs(int slot) {
+    ContactPair* pairs = sim.pairs.items;
+    // A backward shift that wraps past the table end can move an entry into
+    // a slot this pass has already scanned, so repeat until a pass is clean
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        for (Uint32 i = 0; i < (Uint32)sim.pairs.count; i++) {
+            while (pairs[i].used && (pairs[i].a == slot || pairs[i].b == slot)) {
+                remove_pair_at(i);
+                removed = true;
+            }
+        }
+    }
+    for (int i = 0; i < events.count; i++) {
+        if (events.items[i].a->slot == slot || events.items[i].b->slot == slot)
+            events.items[i].phase = CONTACT_NONE;
+    }
+}
+
+static void record_contact(ContactPair* p, bool hit) {
+    p->last_seen = sim.contact_tick;
+    if (hit) {
+        push_event(p, p->touching ? CONTACT_STAY : CONTACT_ENTER);
+        p->touching = true;
+    } else if (p->touching) {
+        p->touching = false;
+        push_event(p, CONTACT_EXIT);
+    }
+}
+
+static void narrowphase_pair(ColliderComponent* c1, ColliderComponent* c2) {
+    ContactPair* p = get_pair(c1->entity, c2->entity);
+    if (!p) return;     // out of memory, logged by grow_pairs
+
+    // Orient the pair's own a -> b, whatever order the broadphase found it in
+    const ColliderComponent* ca = (c1->entity == p->a) ? c1 : c2;
+    const ColliderComponent* cb = (ca == c1) ? c2 : c1;
+    record_contact(p, collide_colliders(ca, cb, &p->axis, &p->manifold));
+}
+
+// Circle-polygon pairs wait until the broadphase is done, then go through
+// the batch kernel one polygon at a time: the outline is transformed once
+// and most circles are rejected by a few multiply-adds instead of a SAT
+typedef struct {
+    int polygon;        // collider indices
+    int circle;
+} CirclePair;
+
+// Per-tick scratch, grown to the largest scene seen
+static ARRAY(CirclePair) circle_pairs;
+static ARRAY(CirclePair) circle_sorted;
+static ARRAY(int) group_start;
+static ARRAY(int) group_fill;
+static ARRAY(float) circle_x;
+static ARRAY(float) circle_y;
+static ARRAY(float) circle_r;
+static ARRAY(Uint8) circle_hits;
+static ARRAY(int) awake;
+static ARRAY(bool) is_awake;
+
+static void circles_vs_polygon(const ColliderComponent* pc, const CirclePair* pairs, int n) {
+    int count = pc->polygon.point_count;
+    SDL_Point stack[COLLISION_STACK_POINTS];
+    SDL_Point* poly = (count <= COLLISION_STACK_POINTS) ? stack : malloc(sizeof(SDL_Point) * count);
+    if (!poly) return;
+    transform_polygon(pc->polygon.points, poly, count, sim_entity(pc->entity));
+
+    // A polygon meets each circle at most once, so n <= the collider count
+    // and run_circle_pairs has reserved that much
+    float* x = circle_x.items;
+    float* y = circle_y.items;
+    float* r = circle_r.items;
+    Uint8* hits = circle_hits.items;
+    for (int k = 0; k < n; k++) {
+        const ColliderComponent* cc = &sim.colliders.items[pairs[k].circle];
+        collider_circle_center(cc, sim_entity(cc->entity), &x[k], &y[k]);
+        r[k] = cc->circle.radius;
+    }
+
+    ConvexHalfPlanes hp;
+    if (convex_half_planes(poly, count, &hp))
+        circles_vs_half_planes(&hp, x, y, r, n, hits);
+    else
+        memset(hits, 1, n);     // degenerate or huge outline: SAT decides
+
+    for (int k = 0; k < n; k++) {
+        const ColliderComponent* cc = &sim.colliders.items[pairs[k].circle];
+        ContactPair* p = get_pair(pc->entity, cc->entity);
+        if (!p) continue;
+        // A kernel miss is final: the circle is clear of the outline's hull
+        bool hit = hits[k] && polygon_circle_sat(poly, count, x[k], y[k], r[k], &p->axis, &p->manifold);
+        if (hit && p->a != pc->entity) {
+            p->manifold.normal_x = -p->manifold.normal_x;
+            p->manifold.normal_y = -p->manifold.normal_y;
+        }
+        record_contact(p, hit);
+    }
+
+    if (poly != stack) free(poly);
+}
+
+// Group the deferred pairs by polygon, keeping broadphase order in a group
+static void run_circle_pairs(void) {
+    int groups = sim.colliders.count;
+    int pairs = circle_pairs.count;
+    circle_pairs.count = 0;
+    if (pairs == 0) return;
+    if (!array_reserve(&group_start, groups + 1) || !array_reserve(&group_fill, groups) ||
+        !array_reserve(&circle_sorted, pairs) || !array_reserve(&circle_x, groups) ||
+        !array_reserve(&circle_y, groups) || !array_reserve(&circle_r, groups) ||
+        !array_reserve(&circle_hits, groups)) {
+        SDL_Log("Out of memory for %d circle pairs", pairs);
+        return;
+    }
+
+    int* start = group_start.items;
+    CirclePair* sorted = circle_sorted.items;
+    memset(start, 0, sizeof(int) * (groups + 1));
+    for (int k = 0; k < pairs; k++)
+        start[circle_pairs.items[k].polygon + 1]++;
+    for (int i = 0; i < groups; i++)
+        start[i + 1] += start[i];
+    memcpy(group_fill.items, start, sizeof(int) * groups);
+    for (int k = 0; k < pairs; k++)
+        sorted[group_fill.items[circle_pairs.items[k].polygon]++] = circle_pairs.items[k];
+
+    for (int i = 0; i < groups; i++) {
+        int n = start[i + 1] - start[i];
+        if (n) circles_vs_polygon(&sim.colliders.items[i], sorted + start[i], n);
+    }
+}
+
+// Pairs the broadphase skipped this tick: bounds apart or both asleep
+static void sweep_pairs(void) {
+    for (int i = 0; i < sim.pairs.count; i++) {
+        ContactPair* p = &sim.pairs.items[i];
+        if (!p->used || p->last_seen == sim.contact_tick) continue;
+
+        // A resting contact stays touching silently until something wakes it
+        const Entity* a = sim_entity(p->a);
+        const Entity* b = sim_entity(p->b);
+        bool resting = a->active && b->active && entity_is_resting(a) && entity_is_resting(b);
+        if (p->touching && resting) continue;
+
+        if (p->touching) {
+            p->touching = false;
+            push_event(p, CONTACT_EXIT);
+        }
+        if (sim.contact_tick - p->last_seen > CONTACT_PAIR_TTL) {
+            remove_pair_at((Uint32)i);
+            i--;    // a later entry may have shifted into this slot
+        }
+    }
+}
+
+static void dispatch_events(void) {
+    // Handlers never push events, so items stay put
+    for (int i = 0; i < events.count; i++) {
+        ContactEvent* ev = &events.items[i];
+        if (ev->phase == CONTACT_NONE) continue;
+
+        ColliderComponent* c1 = get_collider(ev->a);
+        ColliderComponent* c2 = get_collider(ev->b);
+        if (!c1 || !c2) continue;
+
+        // Colliders with a handler own their response; the rest are separated
+        if (c1->on_contact || c2->on_contact) {
+            CollisionManifold flipped = { -ev->manifold.normal_x, -ev->manifold.normal_y, ev->manifold.depth };
+            if (c1->on_contact) c1->on_contact(ev->a, ev->b, ev->phase, &ev->manifold);
+            if (c2->on_contact) c2->on_contact(ev->b, ev->a, ev->phase, &flipped);
+        } else if (ev->phase != CONTACT_EXIT) {
+            float impact = resolve_contact(ev->a, ev->b, &ev->manifold, COLLISION_RESTITUTION);
+            if (impact > 0.0f) {
+                record_impact(ev->a, impact);
+                record_impact(ev->b, impact);
+            }
+        }
+    }
+    events.count = 0;
+}
+
+// Handle all collisions in the system
+void handle_all_collisions(float dt) {
+    (void)dt; // Suppress unused parameter warning
+    sim.contact_tick++;
+    impacts.count = 0;
+
+    // Broadphase: only pairs with an awake body can produce a new contact,
+    // so a settled scene does no narrowphase work at all
+    if (!array_reserve(&awake, sim.colliders.count) || !array_reserve(&is_awake, sim.colliders.count)) {
+        SDL_Log("Out of memory for %d colliders", sim.colliders.count);
+        return;
+    }
+    int awake_count = 0;
+    for (int i = 0; i < sim.colliders.count; i++) {
+        Entity* e = sim_entity(sim.colliders.items[i].entity);
+        is_awake.items[i] = e->active && !entity_is_resting(e) && sim.colliders.items[i].mask != 0;
+        if (is_awake.items[i]) awake.items[awake_count++] = i;
+    }
+
+    // Narrowphase only records events; nothing moves until dispatch
+    for (int a = 0; a < awake_count; a++) {
+        int i = awake.items[a];
+        for (int j = 0; j < sim.colliders.count; j++) {
+            if (j == i || (is_awake.items[j] && j < i)) continue;  // awake pairs once
+            ColliderComponent* c1 = &sim.colliders.items[i];
+            ColliderComponent* c2 = &sim.colliders.items[j];
+            Entity* e2 = sim_entity(c2->entity);
+            if (!e2->active) continue;
+            if (pair_filtered_out(c1, c2)) continue;
+            if (!bounds_overlap(c1, c2)) continue;
+            if (c1->type == c2->type) {
+                narrowphase_pair(c1, c2);
+            } else {
+                bool circle_first = c1->type == COLLIDER_CIRCLE;
+                CirclePair pair = { circle_first ? j : i, circle_first ? i : j };
+                if (!array_push(&circle_pairs, pair)) narrowphase_pair(c1, c2);
+            }
+        }
+    }
+    run_circle_pairs();
+
+    sweep_pairs();
+    dispatch_events();
+}
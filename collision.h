@@ -13,27 +13,133 @@ typedef enum {
     COLLIDER_CIRCLE
 } ColliderType;
 
-// Collider component
+// Layer bits: a pair is tested only if each body's layer is in the other's mask
+#define COLLISION_LAYER_VEHICLE  (1u << 0)
+#define COLLISION_LAYER_EFFECT   (1u << 1)
+#define COLLISION_LAYER_BULLET   (1u << 2)
+#define COLLISION_LAYER_SCENERY  (1u << 3)
+
+#define CONTACT_PAIR_MIN_SLOTS 64    // first table size; doubles to stay at most half full
+#define CONTACT_PAIR_TTL 30          // ticks a non-touching pair keeps its cached axis
+
+// Narrowphase result: push the second body along normal by depth (or the
+// first by -normal) to separate them
+typedef struct {
+    float normal_x, normal_y;   // unit, from the first body toward the second
+    float depth;                // penetration along normal, px
+} CollisionManifold;
+
+// Last separating axis of a pair, tried first on the next test
+typedef struct {
+    float x, y;
+    bool valid;
+} SatAxis;
+
+typedef enum {
+    CONTACT_NONE,       // cancelled (an entity went away)
+    CONTACT_ENTER,
+    CONTACT_STAY,
+    CONTACT_EXIT
+} ContactPhase;
+
+// Queued by the narrowphase, dispatched once it has finished
+typedef struct {
+    Entity* a;
+    Entity* b;
+    ContactPhase phase;
+    CollisionManifold manifold;  // normal from a toward b; stale on exit
+} ContactEvent;
+
+// Persistent per-pair state keyed by the entity pair (collider indices move
+// on detach). Keeps the last separating axis and whether the pair touched.
 typedef struct {
-    Entity* entity;
+    bool used;              // false marks an empty table entry
+    Sint16 a;               // entity slots, a < b
+    Sint16 b;
+    SatAxis axis;
+    CollisionManifold manifold;
+    bool touching;
+    Uint32 last_seen;       // tick the pair last reached the narrowphase
+} ContactPair;
+
+// Collider component. Lives in SimState; geometry and handler are shared
+// read-only data, so those two pointers survive a snapshot restore.
+typedef struct {
+    Sint16 entity;                 // slot of the owning entity
     ColliderType type;
+    Uint32 layer;                  // what this body is
+    Uint32 mask;                   // what it collides with
     struct {
-        SDL_Point* points;
+        const SDL_Point* points;   // shared local geometry, not owned
         int point_count;
     } polygon;
-    void (*on_collision)(Entity* self, Entity* other);
+    struct {
+        float x, y;                // center in image pixels, like polygon points
+        float radius;
+    } circle;
+    // Called on enter, stay and exit; m points from self toward other. Runs
+    // while the pools are walked: spawn and destroy through command_buffer.h
+    void (*on_contact)(Entity* self, Entity* other, ContactPhase phase, const CollisionManifold* m);
 } ColliderComponent;
 
+#define COLLISION_STACK_POINTS 64    // larger hitboxes fall back to the heap
+#define COLLISION_SLOP 1.0f          // extra px of separation; hitboxes are integer
+#define COLLISION_RESTITUTION 0.2f
+#define COLLISION_CIRCLE_SEGMENTS 16 // debug outline of a circle collider
+
+// Edges of a convex outline as half-planes nx*x + ny*y <= d (unit normals),
+// laid out for the batch kernel
+typedef struct {
+    float nx[COLLISION_STACK_POINTS];
+    float ny[COLLISION_STACK_POINTS];
+    float d[COLLISION_STACK_POINTS];
+    int count;
+} ConvexHalfPlanes;
+
 // API
-void attach_polygon_collider(Entity* e, SDL_Point* points, int point_count);
+void attach_polygon_collider(Entity* e, const SDL_Point* points, int point_count);
+void attach_circle_collider(Entity* e, float x, float y, float radius);
+void detach_collider(Entity* e);
+void collider_set_filter(Entity* e, Uint32 layer, Uint32 mask);
+void collision_default_filter(EntityType type, Uint32* layer, Uint32* mask);
+Uint32 collision_layer_from_name(const char* name);   // 0 if unknown
+// Broadphase, cached narrowphase, then enter/stay/exit dispatch
 void handle_all_collisions(float dt);
+// Hardest impact speed resolved on e by the last handle_all_collisions, 0 if none
+float collision_last_impact(const Entity* e);
 ColliderComponent* get_collider(Entity* entity);
 void draw_all_collision_polygons(SDL_Renderer* renderer, Entity** entities, int count);
 SDL_Point rotate_and_translate(SDL_Point p, float angle_deg, float cx, float cy);
 
 bool check_entities_collision(Entity* e1, Entity* e2);
+bool collide_entities(Entity* e1, Entity* e2, CollisionManifold* out);
 bool polygons_intersect(SDL_Point* poly1, int count1, SDL_Point* poly2, int count2);
-void transform_polygon(SDL_Point* src, SDL_Point* dest, int count, Entity* entity);
+bool polygons_intersect_mtv(const SDL_Point* poly1, int count1, const SDL_Point* poly2, int count2,
+                            CollisionManifold* out);
+// Point tests against world-space outlines; the distance is 0 inside
+bool  polygon_contains_point(const SDL_Point* poly, int count, float x, float y);
+float polygon_point_distance(const SDL_Point* poly, int count, float x, float y);
+
+// Separate two bodies along m and remove their approach velocity; static
+// bodies do not move. Returns the approach speed, 0 if already separating.
+float resolve_contact(Entity* a, Entity* b, const CollisionManifold* m, float restitution);
+void transform_polygon(const SDL_Point* src, SDL_Point* dest, int count, Entity* entity);
+void collider_circle_center(const ColliderComponent* c, const Entity* e, float* x, float* y);
+
+// Circle tests; the normal points from the first shape toward the second
+bool circles_intersect_mtv(float ax, float ay, float ar, float bx, float by, float br,
+                           CollisionManifold* out);
+bool polygon_circle_intersect_mtv(const SDL_Point* poly, int count, float cx, float cy, float r,
+                                  CollisionManifold* out);
+
+// Batch kernel for many small bodies against one big one. The half-planes
+// are those of the outline's convex hull (world space). hits[i] is set when
+// circle i (radius 0 for a point) may touch it: exact for points and convex
+// outlines away from corners; near a corner or a notch it can report a hit
+// the exact test rejects, never the reverse. Returns the number of hits.
+bool convex_half_planes(const SDL_Point* poly, int count, ConvexHalfPlanes* out);
+int  circles_vs_half_planes(const ConvexHalfPlanes* hp, const float* x, const float* y, const float* r,
+                            int count, Uint8* hits);
 void load_entity_hitbox(Entity* e, const char* json_filename);
 void debug_collision_info(Entity* entity);
 
@@ -0,0 +1,127 @@
+#include "command_buffer.h"
+#include "collision.h"
+#include "growable.h"
+#include "hitbox_loader.h"
+#include "sim_state.h"
+
+// Only the owning thread writes a buffer; command_apply reads them all at
+// the sync point, after the writers are done for the tick. Buffers keep
+// their capacity across ticks.
+static ARRAY(Command) buffers[COMMAND_MAX_THREADS];
+static SDL_atomic_t claimed;
+// Claims hold for one tick: a claim from an earlier round is stale, so
+// threads that come and go never use up the buffers
+static int claim_round = 0;
+static _Thread_local int own_buffer = -1;
+static _Thread_local int own_round = -1;
+
+static Command* next_command(void) {
+    if (own_buffer < 0 || own_round != claim_round) {
+        int index = SDL_AtomicAdd(&claimed, 1);
+        if (index >= COMMAND_MAX_THREADS) {
+            SDL_AtomicAdd(&claimed, -1);
+            SDL_Log("Command buffers: more than %d threads this tick", COMMAND_MAX_THREADS);
+            return NULL;
+        }
+        own_buffer = index;
+        own_round = claim_round;
+    }
+    int t = own_buffer;
+    if (!array_reserve(&buffers[t], buffers[t].count + 1)) {
+        SDL_Log("Out of memory in command buffer %d", t);
+        return NULL;
+    }
+    return &buffers[t].items[buffers[t].count++];
+}
+
+static bool queue_targeted(CommandType type, const Entity* e) {
+    if (!e) return false;
+    Command* cmd = next_command();
+    if (!cmd) return false;
+    *cmd = (Command){ .type = type, .slot = e->slot, .generation = sim_links(e)->generation };
+    return true;
+}
+
+bool command_spawn(const char* id, EntityType type, const char* texture_path, float x, float y, float angle,
+                   float speed, Sint16 owner, CommandSpawned spawned) {
+    Command* cmd = next_command();
+    if (!cmd) return false;
+    *cmd = (Command){ .type = COMMAND_SPAWN, .slot = -1, .id = id, .entity_type = type, .texture_path = texture_path,
+                      .x = x, .y = y, .angle = angle, .speed = speed,
+                      .owner = owner, .spawned = spawned };
+    return true;
+}
+
+bool command_destroy(const Entity* e) {
+    return queue_targeted(COMMAND_DESTROY, e);
+}
+
+bool command_attach_hitbox(const Entity* e) {
+    return queue_targeted(COMMAND_ATTACH_HITBOX, e);
+}
+
+bool command_detach_collider(const Entity* e) {
+    return queue_targeted(COMMAND_DETACH_COLLIDER, e);
+}
+
+// The slot may have been destroyed, or destroyed and reused, since queueing
+static Entity* live_target(const Command* cmd) {
+    const EntityLinks* links = sim_link(cmd->slot);
+    if (!links->in_use || links->generation != cmd->generation) return NULL;
+    return sim_entity(cmd->slot);
+}
+
+static bool apply_one(SDL_Renderer* renderer, const Command* cmd) {
+    if (cmd->type == COMMAND_SPAWN) {
+        Entity* e = spawn_entity_of_type(cmd->id, cmd->entity_type, renderer, cmd->texture_path, cmd->x, cmd->y);
+        if (!e) return false;
+        entity_set_angle(e, cmd->angle);
+        e->speed = cmd->speed;
+        if (cmd->spawned) cmd->spawned(e, cmd->owner);
+        return true;
+    }
+
+    Entity* e = live_target(cmd);
+    if (!e) return false;
+    switch (cmd->type) {
+    case COMMAND_DESTROY:
+        entity_destroy(e);
+        break;
+    case COMMAND_ATTACH_HITBOX:
+        if (get_collider(e)) return false;
+        return hitbox_registry_attach(e);
+    case COMMAND_DETACH_COLLIDER:
+        detach_collider(e);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+int command_apply(SDL_Renderer* renderer) {
+    int applied = 0;
+    int threads = SDL_AtomicGet(&claimed);
+    if (threads > COMMAND_MAX_THREADS) threads = COMMAND_MAX_THREADS;   // a refused claim in flight
+    bool queued = true;
+    while (queued) {
+        // Spawn callbacks queue into this thread's buffer, which may come
+        // before or at the one being applied
+        queued = false;
+        for (int t = 0; t < threads; t++) {
+            if (buffers[t].count == 0) continue;
+            queued = true;
+            for (int i = 0; i < buffers[t].count; i++) {
+                // By value: a spawn callback may grow this buffer under us
+                Command cmd = buffers[t].items[i];
+                if (apply_one(renderer, &cmd)) applied++;
+            }
+            buffers[t].count = 0;
+        }
+    }
+
+    // Every buffer is empty; the next tick claims afresh
+    SDL_AtomicSet(&claimed, 0);
+    claim_round++;
+    return applied;
+}
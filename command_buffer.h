@@ -0,0 +1,53 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+#define COMMAND_MAX_THREADS 16          // threads that may queue in one tick
+
+typedef enum {
+    COMMAND_SPAWN,
+    COMMAND_DESTROY,
+    COMMAND_ATTACH_HITBOX,
+    COMMAND_DETACH_COLLIDER
+} CommandType;
+
+// Runs on the new entity during the apply, where touching pools is safe;
+// owner is the slot given to command_spawn
+typedef void (*CommandSpawned)(Entity* e, Sint16 owner);
+
+typedef struct {
+    CommandType type;
+    Sint16 slot;                // destroy, attach, detach: the target
+    Uint32 generation;          // the target as it was when queued
+    const char* id;             // spawn: must outlive the apply (literals, registry labels)
+    EntityType entity_type;
+    const char* texture_path;
+    float x, y, angle, speed;
+    Sint16 owner;               // spawn: the spawner's slot, -1 = none
+    CommandSpawned spawned;     // optional
+} Command;
+
+// Structural changes to the entity pool, queued from anywhere and applied
+// at one sync point per tick. Systems that iterate pools (bullet update,
+// contact callbacks, AI, worker jobs) queue instead of spawning or
+// destroying in place. Each thread appends to a growable buffer of its
+// own, so queueing takes no lock; a thread claims a buffer on its first
+// command of the tick and command_apply releases every claim. Queueing
+// returns false when more than COMMAND_MAX_THREADS threads queue in one
+// tick, or out of memory.
+bool command_spawn(const char* id, EntityType type, const char* texture_path, float x, float y, float angle,
+                   float speed, Sint16 owner, CommandSpawned spawned);
+bool command_destroy(const Entity* e);
+bool command_attach_hitbox(const Entity* e);       // registry hitbox, if it has no collider yet
+bool command_detach_collider(const Entity* e);
+
+// Main thread, while no other thread queues: apply every buffer in claim
+// order, each in the order it was filled, including commands queued by
+// spawn callbacks. Commands aimed at an entity that is gone by then are
+// dropped. Returns the number applied.
+int command_apply(SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "dirty_rects.h"
+
+typedef struct {
+    SDL_Rect rect;
+    const void* what;
+    float angle;
+} DrawnSprite;
+
+typedef enum {
+    PASS_OFF,       // mode disabled: draw everything
+    PASS_RECORD,    // collect bounds only
+    PASS_DRAW       // draw what touches the current dirty rect
+} DirtyPass;
+
+static SDL_Texture* frame_cache = NULL;
+static int cache_w = 0, cache_h = 0;
+static SDL_Color bg;
+static bool preserved_backbuffer = false;   // software renderer keeps its backbuffer
+static bool first_frame = true;
+
+static DrawnSprite frames[2][MAX_DRAWN_SPRITES];
+static int frame_counts[2] = { 0, 0 };
+static int current = 0;
+static bool overflowed = false;
+
+static DirtyPass pass = PASS_OFF;
+static SDL_Rect active_clip;
+
+static SDL_Rect dirty[MAX_DIRTY_RECTS];
+static int dirty_count = 0;
+static bool dirty_full = false;
+
+bool dirty_rects_wanted(void) {
+    const char* env = SDL_getenv("TANK_DIRTY_RECTS");
+    return env && atoi(env) != 0;
+}
+
+bool dirty_rects_init(SDL_Renderer* renderer, int width, int height, SDL_Color background) {
+    frame_cache = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!frame_cache) {
+        SDL_Log("Dirty-rect mode unavailable: %s", SDL_GetError());
+        return false;
+    }
+
+    SDL_RendererInfo info;
+    preserved_backbuffer = SDL_GetRendererInfo(renderer, &info) == 0 &&
+                           (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+
+    cache_w = width;
+    cache_h = height;
+    bg = background;
+    first_frame = true;
+    frame_counts[0] = frame_counts[1] = 0;
+    SDL_Log("Dirty-rect rendering on (%s backbuffer)", preserved_backbuffer ? "preserved" : "full copy");
+    return true;
+}
+
+void dirty_rects_shutdown(void) {
+    if (frame_cache) SDL_DestroyTexture(frame_cache);
+    frame_cache = NULL;
+    pass = PASS_OFF;
+}
+
+bool dirty_rects_enabled(void) {
+    return frame_cache != NULL;
+}
+
+void dirty_rects_invalidate(void) {
+    first_frame = true;
+}
+
+// Axis-aligned box that contains dst rotated about its center
+static SDL_Rect rotated_bounds(const SDL_Rect* dst, float angle) {
+    if (angle == 0.0f) return *dst;
+    int side = (int)ceilf(sqrtf((float)(dst->w * dst->w + dst->h * dst->h))) + 2;
+    SDL_Rect r = { dst->x + dst->w / 2 - side / 2, dst->y + dst->h / 2 - side / 2, side, side };
+    return r;
+}
+
+bool dirty_rects_submit(const SDL_Rect* dst, const void* what, float angle) {
+    if (pass == PASS_OFF) return true;
+
+    SDL_Rect bounds = rotated_bounds(dst, angle);
+    SDL_Rect* r = &bounds;
+    switch (pass) {
+    case PASS_OFF:
+        return true;
+    case PASS_RECORD:
+        if (frame_counts[current] < MAX_DRAWN_SPRITES) {
+            DrawnSprite* d = &frames[current][frame_counts[current]++];
+            d->rect = *r;
+            d->what = what;
+            d->angle = angle;
+        } else {
+            overflowed = true;
+        }
+        return false;
+    case PASS_DRAW:
+        return SDL_HasIntersection(r, &active_clip);
+    }
+    return true;
+}
+
+static void add_dirty(const SDL_Rect* r) {
+    if (dirty_full || r->w <= 0 || r->h <= 0) return;
+
+    SDL_Rect screen = { 0, 0, cache_w, cache_h };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(r, &screen, &clipped)) return;
+
+    // Grow an overlapping rect rather than keep two
+    for (int i = 0; i < dirty_count; i++) {
+        if (SDL_HasIntersection(&dirty[i], &clipped)) {
+            SDL_UnionRect(&dirty[i], &clipped, &dirty[i]);
+            return;
+        }
+    }
+    if (dirty_count == MAX_DIRTY_RECTS) {
+        dirty_full = true;
+        return;
+    }
+    dirty[dirty_count++] = clipped;
+}
+
+// Unions can create new overlaps; merge until stable
+static void coalesce_dirty(void) {
+    bool merged = true;
+    while (merged && !dirty_full) {
+        merged = false;
+        for (int i = 0; i < dirty_count && !merged; i++) {
+            for (int j = i + 1; j < dirty_count; j++) {
+                if (SDL_HasIntersection(&dirty[i], &dirty[j])) {
+                    SDL_UnionRect(&dirty[i], &dirty[j], &dirty[i]);
+                    dirty[j] = dirty[--dirty_count];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Past half the screen one full redraw is cheaper than many clips
+    long area = 0;
+    for (int i = 0; i < dirty_count; i++)
+        area += (long)dirty[i].w * dirty[i].h;
+    if (area * 2 > (long)cache_w * cache_h)
+        dirty_full = true;
+}
+
+static void collect_dirty(void) {
+    const DrawnSprite* prev = frames[current ^ 1];
+    const DrawnSprite* cur = frames[current];
+    int n_prev = frame_counts[current ^ 1];
+    int n_cur = frame_counts[current];
+
+    dirty_count = 0;
+    dirty_full = first_frame || overflowed;
+
+    // Sprites are matched by submission order, which is stable frame to frame
+    int n = (n_prev > n_cur) ? n_prev : n_cur;
+    for (int i = 0; i < n && !dirty_full; i++) {
+        if (i >= n_prev) {
+            add_dirty(&cur[i].rect);
+        } else if (i >= n_cur) {
+            add_dirty(&prev[i].rect);
+        } else if (!cur[i].what || prev[i].what != cur[i].what || prev[i].angle != cur[i].angle ||
+                   prev[i].rect.x != cur[i].rect.x || prev[i].rect.y != cur[i].rect.y ||
+                   prev[i].rect.w != cur[i].rect.w || prev[i].rect.h != cur[i].rect.h) {
+            add_dirty(&prev[i].rect);
+            add_dirty(&cur[i].rect);
+        }
+    }
+    coalesce_dirty();
+
+    if (dirty_full) {
+        dirty[0] = (SDL_Rect){ 0, 0, cache_w, cache_h };
+        dirty_count = 1;
+    }
+}
+
+void dirty_rects_render_frame(SDL_Renderer* renderer, DirtySceneFn draw_scene, void* ctx) {
+    // 1. Record where everything lands this frame
+    frame_counts[current] = 0;
+    overflowed = false;
+    pass = PASS_RECORD;
+    draw_scene(renderer, ctx);
+
+    collect_dirty();
+
+    // 2. Repaint only the dirty regions of the cached frame
+    SDL_SetRenderTarget(renderer, frame_cache);
+    pass = PASS_DRAW;
+    for (int i = 0; i < dirty_count; i++) {
+        active_clip = dirty[i];
+        SDL_RenderSetClipRect(renderer, &active_clip);
+        SDL_SetRenderDrawColor(renderer, bg.r, bg.g, bg.b, bg.a);
+        SDL_RenderFillRect(renderer, &active_clip);
+        draw_scene(renderer, ctx);
+    }
+    SDL_RenderSetClipRect(renderer, NULL);
+    SDL_SetRenderTarget(renderer, NULL);
+    pass = PASS_OFF;
+
+    // 3. Present: the software backbuffer survives, so only dirty rects move
+    if (preserved_backbuffer && !first_frame) {
+        for (int i = 0; i < dirty_count; i++)
+            SDL_RenderCopy(renderer, frame_cache, &dirty[i], &dirty[i]);
+    } else {
+        SDL_RenderCopy(renderer, frame_cache, NULL, NULL);
+    }
+    SDL_RenderPresent(renderer);
+
+    first_frame = false;
+    current ^= 1;
+}
@@ -0,0 +1,32 @@
+#ifndef DIRTY_RECTS_H
+#define DIRTY_RECTS_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define MAX_DRAWN_SPRITES 1024
+#define MAX_DIRTY_RECTS 16          // beyond this the frame is redrawn whole
+
+typedef void (*DirtySceneFn)(SDL_Renderer* renderer, void* ctx);
+
+// Optional mode for CPU-only hosts: the frame lives in a cached target and
+// only regions whose sprites moved, appeared or vanished are redrawn.
+bool dirty_rects_init(SDL_Renderer* renderer, int width, int height, SDL_Color background);
+void dirty_rects_shutdown(void);
+bool dirty_rects_enabled(void);
+// Redraw the whole next frame, e.g. after texture pixels changed in place
+void dirty_rects_invalidate(void);
+
+// True when TANK_DIRTY_RECTS is set to a non-zero value
+bool dirty_rects_wanted(void);
+
+// Render paths call this with the unrotated screen rect of a draw, what it
+// draws and its angle. Returns whether the caller should issue the SDL call
+// now. Always true when the mode is off. A NULL what marks content that
+// changes every frame (particles) and is always redrawn.
+bool dirty_rects_submit(const SDL_Rect* dst, const void* what, float angle);
+
+// Record the scene, redraw the changed regions into the cache, present them
+void dirty_rects_render_frame(SDL_Renderer* renderer, DirtySceneFn draw_scene, void* ctx);
+
+#endif
@@ -1,46 +1,119 @@
 #include "entity.h"
 #include "mount_system.h"
+#include "asset_loader.h"
+#include "collision.h"
+#include "hitbox_loader.h"
+#include "camera.h"
+#include "animation_system.h"
+#include "rotation_cache.h"
+#include "dirty_rects.h"
+#include "sim_state.h"
 #include <math.h>
-#include <SDL_image.h>
 
-#define MAX_ENTITIES 128
+// The hot pool, links and free list live in sim; cold data is outside the
+// snapshot and keyed by slot
+EntityColdPool entity_cold_pool;
 
-Entity entities[MAX_ENTITIES];
-static const char* entity_names[MAX_ENTITIES];
-static int entity_count = 0;
+// Not simulation state: keeps counting across rollbacks so a respawned slot
+// never matches the cold data of an earlier spawn
+static Uint32 next_generation = 1;
 
 Entity* find_entity(const char* name) {
-    for (int i = 0; i < entity_count; i++) {
-        if (strcmp(entity_names[i], name) == 0)
-            return &entities[i];
+    for (int i = 0; i < sim.entity_count; i++) {
+        const EntityCold* c = pool_at(&entity_cold_pool, i);
+        if (sim_link(i)->in_use && c->id && strcmp(c->id, name) == 0)
+            return sim_entity(i);
     }
     return NULL;
 }
 
-Entity* spawn_entity(const char* id, SDL_Renderer* renderer, const char* texture_path, float x, float y) {
-    if (entity_count >= MAX_ENTITIES) {
-        SDL_Log("Entity limit reached.");
-        return NULL;
+// Textures, frames and the animation slot of whatever used the slot before
+static void release_cold(EntityCold* c) {
+    if (c->type == ENTITY_ANIMATED) {
+        for (int i = 0; i < c->frame_count && c->frames; i++)
+            asset_release_texture(c->frames[i]);
+        free(c->frames);
+        animation_release(c->anim);
     }
+    asset_release_texture(c->texture);
+    free(c->id);
+    memset(c, 0, sizeof(EntityCold));
+    c->anim = -1;
+}
 
-    SDL_Surface* surface = IMG_Load(texture_path);
-    if (!surface) {
-        SDL_Log("IMG_Load failed: %s", IMG_GetError());
+bool entity_pool_reserve(int slots) {
+    if (slots > ENTITY_SLOT_LIMIT) return false;
+    return pool_reserve(&sim.entities, slots) && pool_reserve(&sim.links, slots) &&
+           pool_reserve(&entity_cold_pool, slots);
+}
+
+static int pop_free_slot(void) {
+    int slot = sim.free_slots.items[sim.free_head++];
+    // Drop the consumed front once it is most of the list
+    if (sim.free_head == sim.free_slots.count) {
+        sim.free_head = sim.free_slots.count = 0;
+    } else if (sim.free_head >= 64 && 2 * sim.free_head >= sim.free_slots.count) {
+        sim.free_slots.count -= sim.free_head;
+        memmove(sim.free_slots.items, sim.free_slots.items + sim.free_head, sizeof(Sint16) * sim.free_slots.count);
+        sim.free_head = 0;
+    }
+    return slot;
+}
+
+Entity* entity_alloc(void) {
+    // Oldest free slot first, and only once it has left the rollback window
+    // (a restore may still revive its entity); until then the pool grows
+    bool have_free = sim.free_head < sim.free_slots.count;
+    bool head_settled = have_free &&
+        sim.tick - sim_link(sim.free_slots.items[sim.free_head])->freed_tick >= SIM_ROLLBACK_FRAMES;
+    bool can_grow = !head_settled && entity_pool_reserve(sim.entity_count + 1);
+
+    int slot;
+    if (have_free && !can_grow) {
+        slot = pop_free_slot();
+    } else if (can_grow) {
+        slot = sim.entity_count++;
+    } else {
+        SDL_Log("Out of entity slots (%d)", sim.entity_count);
         return NULL;
     }
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+    release_cold(pool_at(&entity_cold_pool, slot));
+
+    Entity* e = sim_entity(slot);
+    memset(e, 0, sizeof(Entity));
+    e->slot = (Sint16)slot;
+    e->heading_cos = 1.0f;   // angle 0
+
+    Uint32 generation = next_generation++;
+    entity_cold(e)->generation = generation;
+    *sim_link(slot) = (EntityLinks){ true, -1, -1, 0, -1, -1, generation, 0 };
+    return e;
+}
+
+Entity* spawn_entity(const char* id, SDL_Renderer* renderer, const char* texture_path, float x, float y) {
+    return spawn_entity_of_type(id, ENTITY_BASIC, renderer, texture_path, x, y);
+}
 
+Entity* spawn_entity_of_type(const char* id, EntityType type, SDL_Renderer* renderer, const char* texture_path,
+                             float x, float y) {
+    // Waits on the decode pool if the image was prefetched
+    SDL_Texture* texture = asset_take_texture(renderer, texture_path);
     if (!texture) {
-        SDL_Log("Failed to create texture: %s", SDL_GetError());
+        SDL_Log("Failed to load texture: %s", texture_path);
         return NULL;
     }
 
-    Entity* e = &entities[entity_count];
-    memset(e, 0, sizeof(Entity));
+    Entity* e = entity_alloc();
+    if (!e) {
+        asset_release_texture(texture);
+        return NULL;
+    }
+    EntityCold* c = entity_cold(e);
 
-    e->texture = texture;
+    c->texture = texture;
+    c->id = strdup(id);
+    c->type = type;
     e->x = x;
     e->y = y;
     e->angle = 0;
@@ -48,58 +121,88 @@ Entity* spawn_entity(const char* id, SDL_Renderer* renderer, const char* texture
     e->friction = 60;
     e->max_speed = 300;
     e->active = true;
-    e->id = strdup(id);
 
     SDL_QueryTexture(texture, NULL, NULL, &e->width, &e->height);
 
-    entity_names[entity_count] = strdup(id);  // optional external tracking
-    entity_count++;
+    // O(1) lookup; every instance shares the registry's local polygon
+    hitbox_registry_attach(e);
 
     return e;
 }
 
 int entity_load_texture(SDL_Renderer* renderer, Entity* e, const char* filepath) {
-    SDL_Surface* surf = IMG_Load(filepath);
-    if (!surf) return 0;
-    e->texture = SDL_CreateTextureFromSurface(renderer, surf);
-    if (!e->texture) {
-        SDL_FreeSurface(surf);
-        return 0;
-    }
-    e->width = surf->w;
-    e->height = surf->h;
-    
-    SDL_FreeSurface(surf);
-    return e->texture != NULL;
+    EntityCold* c = entity_cold(e);
+    c->texture = asset_take_texture(renderer, filepath);
+    if (!c->texture) return 0;
+    SDL_QueryTexture(c->texture, NULL, NULL, &e->width, &e->height);
+    return 1;
 }
 
 void entity_unload(Entity* e) {
-    if (e->texture) SDL_DestroyTexture(e->texture);
-    e->texture = NULL;
+    EntityCold* c = entity_cold(e);
+    asset_release_texture(c->texture);
+    c->texture = NULL;
+}
+
+void entity_retarget_texture(SDL_Texture* from, SDL_Texture* to) {
+    // Free slots too: their cold data may still be revived by a rollback
+    for (int i = 0; i < sim.entity_count; i++) {
+        EntityCold* c = pool_at(&entity_cold_pool, i);
+        Entity* e = sim_entity(i);
+        if (c->texture == from) {
+            c->texture = to;
+            SDL_QueryTexture(to, NULL, NULL, &e->width, &e->height);
+        }
+        for (int f = 0; f < c->frame_count && c->frames; f++) {
+            if (c->frames[f] != from) continue;
+            c->frames[f] = to;
+            if (f == 0) SDL_QueryTexture(to, NULL, NULL, &e->width, &e->height);
+        }
+    }
+}
+
+void entity_wake(Entity* e) {
+    e->sleeping = false;
+    e->sleep_timer = 0.0f;
+}
+
+bool entity_is_static(const Entity* e) {
+    return e->friction == 0 && e->max_speed == 0 && e->speed == 0;
+}
+
+bool entity_is_resting(const Entity* e) {
+    return e->sleeping || entity_is_static(e);
 }
 
 void entity_turn(Entity* e, float angle_delta) {
-    e->angle += angle_delta;
+    entity_wake(e);
+    entity_set_angle(e, e->angle + angle_delta);
 }
 
 void entity_thrust(Entity* e, float amount) {
+    entity_wake(e);
     e->speed += amount;
     if (e->speed > e->max_speed) e->speed = e->max_speed;
     if (e->speed < -e->max_speed) e->speed = -e->max_speed;
 }
 
+void entity_set_update(Entity* e, void (*update)(Entity*, float dt)) {
+    entity_cold(e)->update = update;
+    e->has_update = update != NULL;
+}
+
 void entity_update(Entity* e, const Uint8* keystate, float dt) {
     (void)keystate;  // Currently unused
 
     if (!e) return;
 
-    // Defensive: avoid updating unloaded or malformed entities
-    if (e->update) {
-        e->update(e, dt);
+    // The hot bit keeps entities without logic out of the cold table
+    if (e->has_update) {
+        entity_cold(e)->update(e, dt);
     }
 
-    // Skip physics for destroyed or non-movable entities
-    if (e->friction == 0 && e->max_speed == 0 && e->speed == 0) return;
+    // Skip physics for sleeping or non-movable entities
+    if (e->sleeping || entity_is_static(e)) return;
 
     // Apply friction
     if (e->speed > 0) {
@@ -116,24 +219,40 @@ void entity_update(Entity* e, const Uint8* keystate, float dt) {
     if (e->speed < -e->max_speed)
         e->speed = -e->max_speed;
 
-    // Integrate position using angle and speed
-    float rad = e->angle * (float)(M_PI / 180.0f);
-    e->x += cosf(rad) * e->speed * dt;
-    e->y += sinf(rad) * e->speed * dt;
+    // Integrate position using the cached heading and speed
+    if (e->heading_angle != e->angle)
+        entity_set_angle(e, e->angle);
+    e->x += e->heading_cos * e->speed * dt;
+    e->y += e->heading_sin * e->speed * dt;
+
+    // Fall asleep after resting long enough; a wake call restarts the clock
+    if (fabsf(e->speed) < SLEEP_SPEED_THRESHOLD) {
+        e->sleep_timer += dt;
+        if (e->sleep_timer >= SLEEP_DELAY) {
+            e->speed = 0;
+            e->sleeping = true;
+        }
+    } else {
+        e->sleep_timer = 0.0f;
+    }
 }
 
 void entity_render(SDL_Renderer* renderer, const Entity* e, int width, int height) {
     if (!e->active) return;
 
-    // Convert center position to top-left for SDL rendering
-    int render_x = (int)(e->x - width / 2.0f);
-    int render_y = (int)(e->y - height / 2.0f);
-    
-    SDL_Rect dst = { render_x, render_y, width, height };
+    // Cull before touching SDL
+    if (!camera_is_entity_visible(e, width, height)) return;
+
+    SDL_Rect dst = camera_project_rect(e->x, e->y, width, height);
+    SDL_Texture* texture = entity_cold(e)->texture;
+    if (!dirty_rects_submit(&dst, texture, e->angle)) return;
+
+    // Software renderer: blit a pre-rotated variant instead of rotating
+    if (rotation_cache_draw(renderer, texture, &dst, e->angle)) return;
     
     // For center-based rotation, we don't need to specify a center point
     // SDL will rotate around the center of the destination rectangle
-    SDL_RenderCopyEx(renderer, e->texture, NULL, &dst, e->angle, NULL, SDL_FLIP_NONE);
+    SDL_RenderCopyEx(renderer, texture, NULL, &dst, e->angle, NULL, SDL_FLIP_NONE);
 }
 
 bool entity_check_collision(Entity* a, Entity* b, int w_a, int h_a, int w_b, int h_b) {
@@ -158,7 +277,9 @@ void mount_to_world_coords(Entity* parent, MountPoint* mount, float* out_x, floa
     interpolate_mount_offset(mount, parent->angle, &offset_x, &offset_y);
 
     // Adjust angle to match sprite orientation - if your sprite points right at 0°, add 90°
-    float angle_rad = (parent->angle + 90.0f) * (M_PI / 180.0f);
+    // cos(a + 90°) = -sin(a), sin(a + 90°) = cos(a)
+    float cos_a, sin_a;
+    entity_heading(parent, &cos_a, &sin_a);
 
     float center_x = parent->x;
     float center_y = parent->y;
@@ -166,15 +287,15 @@ void mount_to_world_coords(Entity* parent, MountPoint* mount, float* out_x, floa
     float forward = -offset_x;  // forward = -X (assuming sprite points up)
     float right   =  offset_y;  // right = +Y
 
-    float rotated_dx = cosf(angle_rad) * forward - sinf(angle_rad) * right;
-    float rotated_dy = sinf(angle_rad) * forward + cosf(angle_rad) * right;
+    float rotated_dx = -sin_a * forward - cos_a * right;
+    float rotated_dy = cos_a * forward - sin_a * right;
 
     *out_x = center_x + rotated_dx;
     *out_y = center_y + rotated_dy;
 }
 
 Entity* entity_create(float x, float y, int width, int height) {
-    Entity* e = calloc(1, sizeof(Entity));
+    Entity* e = entity_alloc();
     if (!e) return NULL;
 
     e->x = x;
@@ -189,53 +310,59 @@ Entity* entity_create(float x, float y, int width, int height) {
     e->friction = 0.9f;
     e->active = true;
 
-    e->texture = NULL;
-    e->mount_points = NULL;
-    e->mounted_entities = NULL;
-    e->entity_mount_count = 0;
-
-    e->update = NULL;  // Optional logic
-
     return e;
 }
 
 void entity_destroy(Entity* e) {
     if (!e) return;
 
-    if (e >= entities && e < entities + MAX_ENTITIES) {
-        entity_unload(e);
-        return;
-    }
+    EntityLinks* links = sim_links(e);
+    if (!links->in_use) return;  // already released
+
+    detach_collider(e);
     
     // Clean up entity mounting system
-    if (e->mount_points) {
-        for (int i = 0; i < e->entity_mount_count; i++) {
-            if (e->mount_points[i].name) {
-                free(e->mount_points[i].name);
-            }
-            if (e->mount_points[i].offsets) {
-                free(e->mount_points[i].offsets);
-            }
-        }
-        free(e->mount_points);
-        free(e->mounted_entities);
-        e->mount_points = NULL;
-        e->mounted_entities = NULL;
-        e->entity_mount_count = 0;
-    }
+    mount_system_cleanup(e);
+
+    // Release the pool slot so streaming and bullets can reuse it. The cold
+    // record stays until then: a rollback past this point revives the entity.
+    links->in_use = false;
+    links->freed_tick = sim.tick;
+    e->active = false;
+    if (!array_push(&sim.free_slots, e->slot))
+        SDL_Log("Out of memory: entity slot %d is not reused", e->slot);
+}
 
-    // Clean up other resources
-    if (e->texture) {
-        SDL_DestroyTexture(e->texture);
+void entity_pool_shutdown(void) {
+    for (int i = 0; i < sim.entity_count; i++) {
+        if (sim_link(i)->in_use) entity_destroy(sim_entity(i));
     }
-    if (e->id) {
-        free(e->id);
+    // Pages are kept: nothing is freed that a stale Entity pointer could reach
+    for (int i = 0; i < pool_capacity(&entity_cold_pool); i++)
+        release_cold(pool_at(&entity_cold_pool, i));
+    for (int i = 0; i < sim.entity_count; i++)
+        memset(sim_link(i), 0, sizeof(EntityLinks));
+    sim.entity_count = 0;
+    sim.free_head = sim.free_slots.count = 0;
+}
+
+void entity_pool_check_restored(void) {
+    for (int i = 0; i < sim.entity_count; i++) {
+        EntityLinks* links = sim_link(i);
+        if (!links->in_use || links->generation == pool_at(&entity_cold_pool, i)->generation) continue;
+        SDL_Log("Rollback: slot %d was reused inside the window, entity dropped", i);
+        entity_destroy(sim_entity(i));
     }
-    
-    free(e);
+}
+
+void entity_set_angle(Entity* e, float angle) {
+    e->angle = angle;
+    e->heading_angle = angle;
+    fast_sincos_deg(angle, &e->heading_sin, &e->heading_cos);
 }
 
 void entity_set_position(Entity* e, float x, float y) {
+    if (e->x != x || e->y != y) entity_wake(e);
     e->x = x;
     e->y = y;
 }
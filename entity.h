@@ -4,6 +4,12 @@
 #include <SDL.h>
 #include <stdbool.h>
 #include "mount_system.h"
+#include "fast_trig.h"
+#include "growable.h"
+
+#define SLEEP_SPEED_THRESHOLD 1.0f   // px/s
+#define SLEEP_DELAY 0.5f             // seconds at rest before sleeping
+#define FIXED_DT (1.0f / 60.0f)      // simulation tick, local and server
 
 typedef enum {
     ENTITY_BASIC,
@@ -12,56 +18,129 @@ typedef enum {
     ENTITY_BULLET,
 } EntityType;
 
+#define ENTITY_SLOT_LIMIT 32767     // slots are Sint16; the pool grows up to this
+
+// Hot record: everything physics, culling and rendering touch per tick.
+// Kept small and contiguous in the pages of sim.entities; the rest lives in
+// EntityCold.
 typedef struct Entity {
-    EntityType type;
-    char* id;
     float x, y;
     float angle;
+    float heading_cos, heading_sin;   // unit heading, valid while heading_angle == angle
+    float heading_angle;
     float vx, vy;
     float speed, max_speed, accel, friction;      
     int width, height;
-    bool active;
+    float sleep_timer;      // seconds spent below SLEEP_SPEED_THRESHOLD
+    // Bits, so the record stays 64 bytes
+    bool active : 1;
+    bool sleeping : 1;      // at rest: skipped by entity_update and the broadphase
+    bool has_update : 1;    // EntityCold.update is set; set through entity_set_update
+    Sint16 slot;            // pool index: cold record, links, references
+} Entity;
+
+// Relations and pool bookkeeping; simulation state, so slots instead of pointers
+typedef struct {
+    bool in_use;
+    Sint16 mount_parent;    // set by mount_attach, -1 = none
+    Sint16 mount_first;     // first of this entity's MountPoints in sim.mounts, -1 = none
+    Sint16 mount_count;
+    Sint16 chunk;           // world chunk that streamed it in, -1 = none
+    int collider;           // index in sim.colliders, -1 = none
+    Uint32 generation;      // matches EntityCold.generation while the cold data is its own
+    Uint32 freed_tick;      // sim tick of entity_destroy
+} EntityLinks;
+
+// Cold record: identity and resources, indexed by the same slot. Released
+// when the slot is handed out again rather than on destroy, so a rollback
+// that revives the entity still finds its texture.
+typedef struct {
+    EntityType type;
+    char* id;
     SDL_Texture* texture;
 
-    // Optional per-entity logic (e.g., AI)
+    // Optional per-entity logic (e.g., AI); entity_update only looks when
+    // Entity.has_update says there is one
     void (*update)(struct Entity*, float dt);
 
-    MountPoint* mount_points;
-    Entity** mounted_entities;
-    int entity_mount_count;
-} Entity;
-
-typedef struct {
-    Entity base;
+    // ENTITY_ANIMATED only
     SDL_Texture** frames;
     int frame_count;
-    int current_frame;
-    float frame_timer;
-    float frame_delay_ms;
-    bool is_animated;
-} AnimatedEntity;
+    int anim;               // handle into the animation system
+
+    Uint32 generation;
+} EntityCold;
+
+// Animated entities are ordinary pool entities with frames in their cold record
+typedef Entity AnimatedEntity;
+
+typedef POOL(EntityCold) EntityColdPool;
+extern EntityColdPool entity_cold_pool;
+
+static inline EntityCold* entity_cold(const Entity* e) {
+    return pool_at(&entity_cold_pool, e->slot);
+}
+
+// For callers of the old e->id and e->texture fields
+static inline const char* entity_id(const Entity* e) {
+    return entity_cold(e)->id;
+}
+
+static inline SDL_Texture* entity_texture(const Entity* e) {
+    return entity_cold(e)->texture;
+}
+
+// Unit heading of e->angle. entity_set_angle keeps the cache fresh; an angle
+// written directly is still handled, just without the cache.
+static inline void entity_heading(const Entity* e, float* out_cos, float* out_sin) {
+    if (e->heading_angle == e->angle) {
+        *out_cos = e->heading_cos;
+        *out_sin = e->heading_sin;
+    } else {
+        fast_sincos_deg(e->angle, out_sin, out_cos);
+    }
+}
 
 // Lifecycle
-extern Entity entities[];
+Entity* entity_alloc(void);     // zeroed pool slot, NULL when out of slots or memory
+bool    entity_pool_reserve(int slots);     // optional: grow up front instead of on demand
 Entity* entity_create(float x, float y, int width, int height);
 Entity* spawn_entity(const char* id, SDL_Renderer* renderer, const char* texture_path, float x, float y);
+// The type is set before the hitbox is attached, so the collider gets its default filter
+Entity* spawn_entity_of_type(const char* id, EntityType type, SDL_Renderer* renderer, const char* texture_path,
+                             float x, float y);
 Entity* find_entity(const char* name);
 void    entity_destroy(Entity* e);
 int     entity_load_texture(SDL_Renderer* renderer, Entity* e, const char* filepath);
 void    entity_unload(Entity* e);
+// Point every cold record that uses `from` at `to` (hot reload of a resized image)
+void    entity_retarget_texture(SDL_Texture* from, SDL_Texture* to);
+void    entity_pool_shutdown(void);     // destroys everything and frees all cold data
+
+// After sim_state_restore: a live slot whose cold data belongs to a later
+// spawn of the same slot cannot be drawn, so it is destroyed
+void    entity_pool_check_restored(void);
 
 // Logic
 void entity_update(Entity* e, const Uint8* keystate, float dt);
+// Install (or with NULL remove) the per-entity logic entity_update runs
+void entity_set_update(Entity* e, void (*update)(Entity*, float dt));
 void entity_turn(Entity* e, float angle_delta);
 void entity_thrust(Entity* e, float amount);
 bool entity_check_collision(Entity* a, Entity* b, int w_a, int h_a, int w_b, int h_b);
 bool entity_check_collision_simple(Entity* a, Entity* b);
 
+// Sleeping: thrust, turning, teleports and contacts wake a body
+void entity_wake(Entity* e);
+bool entity_is_static(const Entity* e);    // scenery: never moves on its own
+bool entity_is_resting(const Entity* e);   // static or asleep
+
 // Render
 void entity_render(SDL_Renderer* renderer, const Entity* e, int width, int height);
 
 // Mounting utilities
 void mount_to_world_coords(Entity* parent, MountPoint* mount, float* out_x, float* out_y);
 void entity_set_position(Entity* e, float x, float y);
+void entity_set_angle(Entity* e, float angle);
 
 #endif
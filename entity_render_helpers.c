@@ -1,26 +1,26 @@
 #include "entity.h"
+#include "camera.h"
+#include "dirty_rects.h"
+#include "animation_system.h"
+#include "rotation_cache.h"
 #include <SDL.h>
 
-void render_animated_entity(SDL_Renderer* renderer, AnimatedEntity* ae, float delta_ms) {
-    if (!ae || !ae->base.active) return;
+void render_animated_entity(SDL_Renderer* renderer, const AnimatedEntity* ae) {
+    if (!ae || !ae->active) return;
     
     // Check animation-specific fields
-    if (!ae->frames || ae->frame_count == 0) return;
-    
-    // Update animation timing
-    ae->frame_timer += delta_ms;
-    if (ae->frame_timer >= ae->frame_delay_ms) {
-        ae->frame_timer = 0;
-        ae->current_frame = (ae->current_frame + 1) % ae->frame_count;
-    }
+    const EntityCold* c = entity_cold(ae);
+    if (!c->frames || c->frame_count == 0) return;
     
+    if (!camera_is_entity_visible(ae, ae->width, ae->height)) return;
+
     // Render using base entity position/size and animated texture
-    SDL_Rect dst = {
-        (int)(ae->base.x - ae->base.width / 2),
-        (int)(ae->base.y - ae->base.height / 2),
-        ae->base.width,
-        ae->base.height
-    };
+    SDL_Rect dst = camera_project_rect(ae->x, ae->y, ae->width, ae->height);
     
-    SDL_RenderCopyEx(renderer, ae->frames[ae->current_frame], NULL, &dst, ae->base.angle, NULL, SDL_FLIP_NONE);
+    SDL_Texture* frame = c->frames[animation_current_frame(c->anim) % c->frame_count];
+    if (!dirty_rects_submit(&dst, frame, ae->angle)) return;
+
+    if (rotation_cache_draw(renderer, frame, &dst, ae->angle)) return;
+
+    SDL_RenderCopyEx(renderer, frame, NULL, &dst, ae->angle, NULL, SDL_FLIP_NONE);
 }
@@ -4,6 +4,7 @@
 #include "entity.h"
 #include <SDL.h>
 
-void render_animated_entity(SDL_Renderer* renderer, AnimatedEntity* ae, float delta_ms);
+// Draws the current frame; playback is advanced by animation_tick, not here
+void render_animated_entity(SDL_Renderer* renderer, const AnimatedEntity* ae);
 
 #endif
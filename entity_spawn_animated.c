@@ -1,5 +1,8 @@
 #include "entity.h"
-#include <SDL_image.h>
+#include "asset_loader.h"
+#include "hitbox_loader.h"
+#include "animation_system.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -45,54 +48,68 @@
 /*     return e; */
 /* } */
 
+// "<base_path><i>.png", sized to fit; the caller frees it
+static char* frame_path(const char* base_path, int i) {
+    int len = snprintf(NULL, 0, "%s%d.png", base_path, i);
+    char* path = malloc(len + 1);
+    if (path) snprintf(path, len + 1, "%s%d.png", base_path, i);
+    return path;
+}
+
+void prefetch_animated_frames(const char* base_path, int frame_count) {
+    for (int i = 0; i < frame_count; ++i) {
+        char* path = frame_path(base_path, i);
+        if (!path) return;
+        asset_request_image(path);
+        free(path);
+    }
+}
+
 AnimatedEntity* spawn_animated_entity(const char* id, SDL_Renderer* renderer, const char* base_path, int frame_count, float x, float y) {
-    AnimatedEntity* ae = malloc(sizeof(AnimatedEntity));
+    AnimatedEntity* ae = entity_alloc();
     if (!ae) return NULL;
-    memset(ae, 0, sizeof(AnimatedEntity));
+    EntityCold* c = entity_cold(ae);
 
     // Set entity type
-    ae->base.type = ENTITY_ANIMATED;
+    c->type = ENTITY_ANIMATED;
     // Set base entity properties
-    ae->base.x = x;
-    ae->base.y = y;
-    ae->base.angle = 0.0f;
-    ae->base.active = true;
+    ae->x = x;
+    ae->y = y;
+    ae->angle = 0.0f;
+    ae->active = true;
     
     // Set animated-specific properties
-    ae->base.id = strdup(id);
-    ae->frame_count = frame_count;
-    ae->current_frame = 0;
-    ae->frame_timer = 0;
-    ae->frame_delay_ms = 80;
-    ae->is_animated = true;
+    c->id = strdup(id);
+    c->frame_count = frame_count;
+    c->anim = -1;
     
-    ae->frames = malloc(sizeof(SDL_Texture*) * frame_count);
-    if (!ae->frames) {
-        free(ae->base.id);
-        free(ae);
+    c->frames = calloc(frame_count, sizeof(SDL_Texture*));
+    if (!c->frames) {
+        entity_destroy(ae);
         return NULL;
     }
     
-    char path[128];
     for (int i = 0; i < frame_count; ++i) {
-        snprintf(path, sizeof(path), "%s%d.png", base_path, i);
-        SDL_Surface* surf = IMG_Load(path);
-        if (!surf) {
-            SDL_Log("Failed to load frame %d for %s: %s", i, id, IMG_GetError());
-            // Cleanup on failure
-            for (int j = 0; j < i; ++j)
-                SDL_DestroyTexture(ae->frames[j]);
-            free(ae->frames);
-            free(ae->base.id);
-            free(ae);
+        char* path = frame_path(base_path, i);
+        c->frames[i] = path ? asset_take_texture(renderer, path) : NULL;
+        free(path);
+        if (!c->frames[i]) {
+            SDL_Log("Failed to load frame %d for %s", i, id);
+            // Never spawned, so no rollback can revive it: release the
+            // frames loaded so far now rather than when the slot is reused
+            for (int j = 0; j < i; j++)
+                asset_release_texture(c->frames[j]);
+            free(c->frames);
+            c->frames = NULL;
+            c->frame_count = 0;
+            entity_destroy(ae);
             return NULL;
         }
-        ae->frames[i] = SDL_CreateTextureFromSurface(renderer, surf);
-        SDL_FreeSurface(surf);
     }
     
-    SDL_QueryTexture(ae->frames[0], NULL, NULL, &ae->base.width, &ae->base.height);
+    SDL_QueryTexture(c->frames[0], NULL, NULL, &ae->width, &ae->height);
+    c->anim = animation_register(frame_count, 80);
+    hitbox_registry_attach(ae);
     
-    // Return as Entity* (safe because base is first member)
     return ae;
 }
@@ -4,6 +4,8 @@
 #include "entity.h"
 #include <SDL.h>
 
+// Queue every frame of a flipbook on the asset loader ahead of the spawn
+void prefetch_animated_frames(const char* base_path, int frame_count);
 AnimatedEntity* spawn_animated_entity(const char* id, SDL_Renderer* renderer, const char* base_path, int frame_count, float x, float y);
 
 #endif
@@ -0,0 +1,90 @@
+#include <math.h>
+#include <string.h>
+#include "fast_trig.h"
+
+// Cephes-style sinf/cosf: reduce to an octant around a multiple of pi/4,
+// then one short minimax polynomial for each
+#define FOPI 1.27323954473516f          // 4 / pi
+#define DP1 0.78515625f                 // pi/4 split into three parts
+#define DP2 2.4187564849853515625e-4f
+#define DP3 3.77489497744594108e-8f
+#define DEG2RAD 0.017453292519943295f
+
+static inline float wrap_radians(float deg) {
+    deg -= 360.0f * floorf(deg * (1.0f / 360.0f));
+    return deg * DEG2RAD;
+}
+
+void fast_sincos_deg(float deg, float* out_sin, float* out_cos) {
+    float x = wrap_radians(deg);
+
+    int j = (int)(x * FOPI);
+    j = (j + 1) & ~1;
+    float y = (float)j;
+    x = ((x - y * DP1) - y * DP2) - y * DP3;
+
+    float z = x * x;
+    float ps = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+    float pc = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z
+               - 0.5f * z + 1.0f;
+
+    // Octant picks which polynomial and which sign
+    float s = (j & 2) ? pc : ps;
+    float c = (j & 2) ? ps : pc;
+    *out_sin = (j & 4) ? -s : s;
+    *out_cos = ((j + 2) & 4) ? -c : c;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+typedef float v4f __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+
+static inline v4f v4_select(v4i m, v4f a, v4f b) {
+    return (v4f)(((v4i)a & m) | ((v4i)b & ~m));
+}
+
+static inline v4f v4_negate_if(v4i m, v4f a) {
+    return (v4f)((v4i)a ^ (m & (v4i){ (int)0x80000000, (int)0x80000000, (int)0x80000000, (int)0x80000000 }));
+}
+
+static void sincos4(const float* deg, float* out_sin, float* out_cos) {
+    v4f d;
+    memcpy(&d, deg, sizeof(v4f));
+
+    // floor of a non-huge float via truncation, corrected for negatives
+    v4f q = d * (1.0f / 360.0f);
+    v4f t = __builtin_convertvector(__builtin_convertvector(q, v4i), v4f);
+    t -= v4_select(t > q, (v4f){ 1.0f, 1.0f, 1.0f, 1.0f }, (v4f){ 0 });
+    v4f x = (d - 360.0f * t) * DEG2RAD;
+
+    v4i j = __builtin_convertvector(x * FOPI, v4i);
+    j = (j + 1) & ~1;
+    v4f y = __builtin_convertvector(j, v4f);
+    x = ((x - y * DP1) - y * DP2) - y * DP3;
+
+    v4f z = x * x;
+    v4f ps = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+    v4f pc = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z
+             - 0.5f * z + 1.0f;
+
+    v4i swap = (j & 2) != 0;
+    v4f s = v4_negate_if((j & 4) != 0, v4_select(swap, pc, ps));
+    v4f c = v4_negate_if(((j + 2) & 4) != 0, v4_select(swap, ps, pc));
+
+    memcpy(out_sin, &s, sizeof(v4f));
+    memcpy(out_cos, &c, sizeof(v4f));
+}
+#endif
+
+void fast_sincos_deg_batch(const float* deg, float* out_sin, float* out_cos, int count) {
+    int i = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    // deg is fully loaded before either output is stored, so aliasing is fine
+    for (; i + 4 <= count; i += 4)
+        sincos4(deg + i, out_sin + i, out_cos + i);
+#endif
+    for (; i < count; i++) {
+        float d = deg[i];
+        fast_sincos_deg(d, &out_sin[i], &out_cos[i]);
+    }
+}
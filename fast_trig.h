@@ -0,0 +1,12 @@
+#ifndef FAST_TRIG_H
+#define FAST_TRIG_H
+
+// sin/cos of angles in degrees. Reduces to [0, 360) first, so accumulated
+// angles (a tank that keeps turning) stay accurate; max abs error ~5.5e-7.
+void fast_sincos_deg(float deg, float* out_sin, float* out_cos);
+
+// Four lanes at a time where the compiler has vector extensions.
+// out_sin/out_cos may alias deg.
+void fast_sincos_deg_batch(const float* deg, float* out_sin, float* out_cos, int count);
+
+#endif
@@ -0,0 +1,160 @@
+#include <stdlib.h>
+#include "frame_pacing.h"
+
+static double period_ms = 1000.0 / 60.0;
+static bool low_latency = false;
+static bool report = false;
+static bool vsync = false;
+static Uint64 freq = 1;
+
+// Default mode: when the next frame starts. Low latency: when it should be
+// presented, one flip after the last present under vsync.
+static Uint64 next_deadline = 0;
+static Uint64 last_present = 0;
+static Uint64 sample_at = 0;        // when this frame sampled input
+static double wait_ms = 0.0;        // waited this frame, either mode
+static double work_peak_ms = 0.0;   // sample -> present, slowly decaying max
+
+static Uint32 oldest_input = 0;     // SDL_GetTicks timestamp of the first input event
+static bool have_input = false;
+static double input_latency_ms = 0.0;
+static double sample_latency_ms = 0.0;
+
+// Report window
+static int frames = 0, input_frames = 0;
+static double sum_input = 0.0, max_input = 0.0, sum_sample = 0.0;
+static double sum_frame = 0.0, max_frame = 0.0, sum_wait = 0.0;
+
+static double ticks_to_ms(Uint64 ticks) {
+    return 1000.0 * (double)ticks / (double)freq;
+}
+
+static Uint64 ms_to_ticks(double ms) {
+    return ms > 0.0 ? (Uint64)(ms * (double)freq / 1000.0) : 0;
+}
+
+// Sleep most of the way, then spin: SDL_Delay can overshoot by a millisecond
+static double wait_until(Uint64 deadline) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (deadline <= start) return 0.0;
+
+    double remaining = ticks_to_ms(deadline - start);
+    if (remaining > FRAME_PACING_SPIN_MS)
+        SDL_Delay((Uint32)(remaining - FRAME_PACING_SPIN_MS));
+    while (SDL_GetPerformanceCounter() < deadline) {
+    }
+    return ticks_to_ms(SDL_GetPerformanceCounter() - start);
+}
+
+bool frame_pacing_low_latency_wanted(void) {
+    const char* env = SDL_getenv("TANK_LOW_LATENCY");
+    return env && atoi(env) != 0;
+}
+
+bool frame_pacing_report_wanted(void) {
+    const char* env = SDL_getenv("TANK_LATENCY_REPORT");
+    return env && atoi(env) != 0;
+}
+
+void frame_pacing_init(SDL_Renderer* renderer, double period, bool low_latency_mode, bool report_on) {
+    SDL_RendererInfo info;
+    vsync = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+    period_ms = period;
+    low_latency = low_latency_mode;
+    report = report_on;
+    freq = SDL_GetPerformanceFrequency();
+    next_deadline = last_present = 0;
+    work_peak_ms = 0.0;
+    SDL_Log("Frame pacing: %.2f ms period, %s mode%s", period_ms,
+            low_latency ? "low-latency" : "default", vsync ? ", vsync" : "");
+}
+
+void frame_pacing_before_input(void) {
+    wait_ms = 0.0;
+    if (low_latency && next_deadline) {
+        // Begin just late enough that sampling, simulating and rendering
+        // end right at the next present
+        Uint64 lead = ms_to_ticks(work_peak_ms + FRAME_PACING_MARGIN_MS);
+        if (next_deadline > lead)
+            wait_ms = wait_until(next_deadline - lead);
+    }
+    sample_at = SDL_GetPerformanceCounter();
+    have_input = false;
+}
+
+void frame_pacing_event(const SDL_Event* e) {
+    switch (e->type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        if (e->key.repeat) return;  // the keyboard state did not change
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+        break;
+    default:
+        return;
+    }
+    if (!have_input || (Sint32)(e->common.timestamp - oldest_input) < 0)
+        oldest_input = e->common.timestamp;
+    have_input = true;
+}
+
+static void report_window(void) {
+    SDL_Log("Latency: input->present %.1f ms avg, %.1f max (%d of %d frames had input); "
+            "sample->present %.2f ms; frame %.2f ms avg, %.2f max; waited %.2f ms/frame",
+            input_frames ? sum_input / input_frames : 0.0, max_input, input_frames, frames,
+            sum_sample / frames, sum_frame / frames, max_frame, sum_wait / frames);
+    frames = input_frames = 0;
+    sum_input = max_input = sum_sample = 0.0;
+    sum_frame = max_frame = sum_wait = 0.0;
+}
+
+void frame_pacing_after_present(void) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint32 now_ms = SDL_GetTicks();
+
+    sample_latency_ms = ticks_to_ms(now - sample_at);
+    input_latency_ms = have_input ? (double)(Uint32)(now_ms - oldest_input) : 0.0;
+
+    // Decays so one hitch does not keep low-latency mode cautious for long
+    work_peak_ms *= 0.98;
+    if (sample_latency_ms > work_peak_ms) work_peak_ms = sample_latency_ms;
+
+    double frame_ms = last_present ? ticks_to_ms(now - last_present) : period_ms;
+    last_present = now;
+
+    Uint64 period = ms_to_ticks(period_ms);
+    if (low_latency && vsync) {
+        next_deadline = now + period;
+    } else {
+        next_deadline = next_deadline ? next_deadline + period : now + period;
+        if (next_deadline < now) next_deadline = now;   // fell behind: no catch-up burst
+    }
+
+    // Under vsync the present already blocked and little is left to wait
+    if (!low_latency)
+        wait_ms = wait_until(next_deadline);
+
+    if (!report) return;
+    frames++;
+    sum_sample += sample_latency_ms;
+    sum_frame += frame_ms;
+    sum_wait += wait_ms;
+    if (frame_ms > max_frame) max_frame = frame_ms;
+    if (have_input) {
+        input_frames++;
+        sum_input += input_latency_ms;
+        if (input_latency_ms > max_input) max_input = input_latency_ms;
+    }
+    if (frames >= FRAME_PACING_REPORT_FRAMES) report_window();
+}
+
+double frame_pacing_input_latency(void) {
+    return input_latency_ms;
+}
+
+double frame_pacing_sample_latency(void) {
+    return sample_latency_ms;
+}
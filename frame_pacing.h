@@ -0,0 +1,38 @@
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define FRAME_PACING_REPORT_FRAMES 300
+#define FRAME_PACING_SPIN_MS 1.5        // sleep until this close, then spin
+#define FRAME_PACING_MARGIN_MS 1.0      // low latency: slack kept before the deadline
+
+// Paces the client loop to one frame per period and measures how long
+// input takes to reach the screen. "On screen" is when SDL_RenderPresent
+// returns, which under vsync is the flip the frame was queued for.
+//
+// Default mode: sample, simulate, render, present, then wait out the rest
+// of the period. Low-latency mode moves the wait in front of the input
+// sample instead: it sleeps until the predicted work of the frame just
+// fits before the next present (the next flip under vsync, the next
+// period otherwise), so input is as fresh as possible.
+// With report on, averages are logged every FRAME_PACING_REPORT_FRAMES.
+void frame_pacing_init(SDL_Renderer* renderer, double period_ms, bool low_latency, bool report);
+
+// TANK_LOW_LATENCY / TANK_LATENCY_REPORT set to a non-zero value
+bool frame_pacing_low_latency_wanted(void);
+bool frame_pacing_report_wanted(void);
+
+// Call right before polling events; low-latency mode waits here
+void frame_pacing_before_input(void);
+// Every polled event; input events keep their SDL timestamp until present
+void frame_pacing_event(const SDL_Event* e);
+// Call right after the frame was presented; default mode waits here
+void frame_pacing_after_present(void);
+
+// Last frame, milliseconds
+double frame_pacing_input_latency(void);   // oldest input event -> present, 0 without input
+double frame_pacing_sample_latency(void);  // input sample -> present
+
+#endif
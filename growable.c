@@ -0,0 +1,45 @@
+#include <string.h>
+#include "growable.h"
+
+bool array_grow(void** items, int* capacity, int needed, size_t elem) {
+    if (needed <= *capacity) return true;
+    int cap = *capacity ? *capacity : 64;
+    while (cap < needed) cap *= 2;
+    void* grown = realloc(*items, elem * cap);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = cap;
+    return true;
+}
+
+bool pool_grow(void*** pages, int* page_count, int needed, size_t elem) {
+    int wanted = (needed + POOL_PAGE_SIZE - 1) / POOL_PAGE_SIZE;
+    if (wanted <= *page_count) return true;
+
+    // Only the page table moves
+    void** table = realloc(*pages, sizeof(void*) * wanted);
+    if (!table) return false;
+    *pages = table;
+    while (*page_count < wanted) {
+        void* page = calloc(POOL_PAGE_SIZE, elem);
+        if (!page) return false;
+        table[(*page_count)++] = page;
+    }
+    return true;
+}
+
+void pool_release(void** pages, int page_count) {
+    for (int i = 0; i < page_count; i++)
+        free(pages[i]);
+    free(pages);
+}
+
+bool pool_copy(void*** dst_pages, int* dst_page_count, void* const* src_pages, int count, size_t elem) {
+    if (!pool_grow(dst_pages, dst_page_count, count, elem)) return false;
+    for (int page = 0; page * POOL_PAGE_SIZE < count; page++) {
+        int n = count - page * POOL_PAGE_SIZE;
+        if (n > POOL_PAGE_SIZE) n = POOL_PAGE_SIZE;
+        memcpy((*dst_pages)[page], src_pages[page], elem * n);
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef GROWABLE_H
+#define GROWABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Type-generic containers that grow by doubling instead of stopping at a
+// compile-time cap. Growth can fail (out of memory), so every call that may
+// allocate returns false for the caller to log.
+
+// Array: contiguous, so items move when it grows. Keep indices, not
+// pointers, across anything that may push.
+#define ARRAY(T) struct { T* items; int count; int capacity; }
+
+bool array_grow(void** items, int* capacity, int needed, size_t elem);
+
+#define array_reserve(a, n) array_grow((void**)&(a)->items, &(a)->capacity, (n), sizeof(*(a)->items))
+#define array_push(a, v) \
+    (array_reserve((a), (a)->count + 1) ? ((a)->items[(a)->count++] = (v), true) : false)
+#define array_free(a) \
+    (free((a)->items), (a)->items = NULL, (a)->count = (a)->capacity = 0)
+
+// Paged pool: fixed pages that never move, so both indices and element
+// addresses stay valid as it grows. New pages are zeroed.
+#define POOL_PAGE_SHIFT 8
+#define POOL_PAGE_SIZE (1 << POOL_PAGE_SHIFT)
+
+#define POOL(T) struct { T** pages; int page_count; }
+
+bool pool_grow(void*** pages, int* page_count, int needed, size_t elem);
+void pool_release(void** pages, int page_count);
+// Copy the first count elements; dst grows to fit and keeps its own pages
+bool pool_copy(void*** dst_pages, int* dst_page_count, void* const* src_pages, int count, size_t elem);
+
+#define pool_reserve(p, n) pool_grow((void***)&(p)->pages, &(p)->page_count, (n), sizeof(**(p)->pages))
+#define pool_capacity(p) ((p)->page_count * POOL_PAGE_SIZE)
+#define pool_at(p, i) (&(p)->pages[(i) >> POOL_PAGE_SHIFT][(i) & (POOL_PAGE_SIZE - 1)])
+#define pool_copy_from(dst, src, n) \
+    pool_copy((void***)&(dst)->pages, &(dst)->page_count, (void* const*)(src)->pages, (n), sizeof(**(src)->pages))
+#define pool_free(p) \
+    (pool_release((void**)(p)->pages, (p)->page_count), (p)->pages = NULL, (p)->page_count = 0)
+
+#endif
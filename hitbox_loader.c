@@ -4,15 +4,356 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <math.h>
 #include <sys/stat.h>
 #include <cjson/cJSON.h>
 #include "entity.h"
 #include "hitbox_loader.h"
 #include "collision.h"
+#include "asset_loader.h"
+#include "sim_state.h"
 
-#define MAX_JSON_PATHS 256
-static char* json_file_paths[MAX_JSON_PATHS];
-static int json_file_count = 0;
+static ARRAY(char*) json_files;
+
+#define MAX_HITBOX_SHAPES 256
+static HitboxShape registry_shapes[MAX_HITBOX_SHAPES];
+static HitboxShape* registry_index[MAX_HITBOX_SHAPES * 2];  // open addressing by label
+static int registry_count = 0;
+
+static char* read_whole_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len < 0) {
+        fclose(f);
+        return NULL;
+    }
+
+    char* data = malloc(len + 1);
+    if (!data) {
+        fclose(f);
+        return NULL;
+    }
+    size_t got = fread(data, 1, len, f);
+    data[got] = '\0';
+    fclose(f);
+    return data;
+}
+
+// labelme shape flags such as {"layer:bullet": true, "mask:scenery": true};
+// "exact" keeps every clicked vertex
+static void parse_collision_flags(const cJSON* flags, Uint32* layer, Uint32* mask, bool* exact) {
+    *layer = *mask = 0;
+    *exact = false;
+    const cJSON* flag;
+    cJSON_ArrayForEach(flag, flags) {
+        if (!cJSON_IsTrue(flag) || !flag->string) continue;
+        if (strcmp(flag->string, "exact") == 0)
+            *exact = true;
+        else if (strncmp(flag->string, "layer:", 6) == 0)
+            *layer |= collision_layer_from_name(flag->string + 6);
+        else if (strncmp(flag->string, "mask:", 5) == 0)
+            *mask |= collision_layer_from_name(flag->string + 5);
+    }
+}
+
+float hitbox_simplify_tolerance(void) {
+    const char* env = SDL_getenv("TANK_HITBOX_TOLERANCE");
+    float tol = env ? (float)atof(env) : HITBOX_DEFAULT_TOLERANCE;
+    return tol > 0.0f ? tol : 0.0f;
+}
+
+// Douglas-Peucker over the chain first..last (indices wrap), marking the
+// vertices that must stay for the chain to remain within tol
+static void simplify_chain(const SDL_Point* p, int count, int first, int last, float tol, bool* keep) {
+    float ax = (float)p[first].x, ay = (float)p[first].y;
+    float dx = (float)p[last].x - ax, dy = (float)p[last].y - ay;
+    float len = sqrtf(dx * dx + dy * dy);
+
+    float worst = 0.0f;
+    int worst_i = -1;
+    for (int i = (first + 1) % count; i != last; i = (i + 1) % count) {
+        float px = (float)p[i].x - ax, py = (float)p[i].y - ay;
+        float d = len > 0.0f ? fabsf(dx * py - dy * px) / len : sqrtf(px * px + py * py);
+        if (d > worst) {
+            worst = d;
+            worst_i = i;
+        }
+    }
+    if (worst_i < 0 || worst <= tol) return;
+
+    keep[worst_i] = true;
+    simplify_chain(p, count, first, worst_i, tol, keep);
+    simplify_chain(p, count, worst_i, last, tol, keep);
+}
+
+// Closed outline: split at vertex 0 and the vertex farthest from it, then
+// simplify both halves. Compacts in place and returns the new count; shapes
+// that would collapse below a triangle are left alone.
+static int simplify_polygon(SDL_Point* p, int count, float tol) {
+    if (count <= 3 || tol <= 0.0f) return count;
+
+    int far = 0;
+    float far_d = -1.0f;
+    for (int i = 1; i < count; i++) {
+        float dx = (float)(p[i].x - p[0].x), dy = (float)(p[i].y - p[0].y);
+        if (dx * dx + dy * dy > far_d) {
+            far_d = dx * dx + dy * dy;
+            far = i;
+        }
+    }
+
+    bool* keep = calloc(count, sizeof(bool));
+    if (!keep) return count;
+    keep[0] = keep[far] = true;
+    simplify_chain(p, count, 0, far, tol, keep);
+    simplify_chain(p, count, far, 0, tol, keep);
+
+    int kept = 0;
+    for (int i = 0; i < count; i++) kept += keep[i];
+    if (kept >= 3) {
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (keep[i]) p[n++] = p[i];
+        }
+        count = n;
+    }
+    free(keep);
+    return count;
+}
+
+bool hitbox_file_parse(const char* json_path, HitboxFile* out) {
+    memset(out, 0, sizeof(*out));
+
+    char* data = read_whole_file(json_path);
+    if (!data) return false;
+
+    cJSON* root = cJSON_Parse(data);
+    free(data);
+    if (!root) return false;
+
+    float tol = hitbox_simplify_tolerance();
+    cJSON* shapes = cJSON_GetObjectItem(root, "shapes");
+    int shape_count = cJSON_GetArraySize(shapes);
+    if (shape_count > 0)
+        out->shapes = calloc(shape_count, sizeof(HitboxShape));
+
+    for (int i = 0; i < shape_count && out->shapes; i++) {
+        cJSON* shape = cJSON_GetArrayItem(shapes, i);
+        cJSON* label = cJSON_GetObjectItem(shape, "label");
+        cJSON* shape_type = cJSON_GetObjectItem(shape, "shape_type");
+        if (!label || !label->valuestring || !shape_type || !shape_type->valuestring) continue;
+        // labelme circles are the center and one point on the rim
+        bool circle = strcmp(shape_type->valuestring, "circle") == 0;
+        if (!circle && strcmp(shape_type->valuestring, "polygon") != 0) continue;
+
+        cJSON* points = cJSON_GetObjectItem(shape, "points");
+        int count = cJSON_GetArraySize(points);
+        if (count < (circle ? 2 : 3)) continue;
+
+        SDL_Point* poly = malloc(sizeof(SDL_Point) * count);
+        if (!poly) continue;
+        for (int j = 0; j < count; j++) {
+            cJSON* pt = cJSON_GetArrayItem(points, j);
+            poly[j].x = (int)cJSON_GetArrayItem(pt, 0)->valuedouble;
+            poly[j].y = (int)cJSON_GetArrayItem(pt, 1)->valuedouble;
+        }
+
+        HitboxShape* hs = &out->shapes[out->shape_count++];
+        bool exact;
+        parse_collision_flags(cJSON_GetObjectItem(shape, "flags"), &hs->layer, &hs->mask, &exact);
+        hs->label = strdup(label->valuestring);
+        hs->points = poly;
+        hs->source_point_count = count;
+        if (circle) {
+            cJSON* center = cJSON_GetArrayItem(points, 0);
+            cJSON* rim = cJSON_GetArrayItem(points, 1);
+            float dx = (float)(cJSON_GetArrayItem(rim, 0)->valuedouble - cJSON_GetArrayItem(center, 0)->valuedouble);
+            float dy = (float)(cJSON_GetArrayItem(rim, 1)->valuedouble - cJSON_GetArrayItem(center, 1)->valuedouble);
+            hs->radius = sqrtf(dx * dx + dy * dy);
+            hs->point_count = hs->source_point_count = 1;
+        } else {
+            hs->point_count = exact ? count : simplify_polygon(poly, count, tol);
+        }
+    }
+
+    cJSON_Delete(root);
+    return true;
+}
+
+void hitbox_file_free(HitboxFile* hf) {
+    if (!hf) return;
+    for (int i = 0; i < hf->shape_count; i++) {
+        free(hf->shapes[i].label);
+        free(hf->shapes[i].points);
+    }
+    free(hf->shapes);
+    hf->shapes = NULL;
+    hf->shape_count = 0;
+}
+
+static Uint32 hash_id(const char* s) {
+    Uint32 h = 2166136261u;  // FNV-1a
+    while (*s) {
+        h ^= (Uint8)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Index of the label's slot in registry_index, or of the empty slot it would take
+static Uint32 find_slot(const char* id) {
+    Uint32 mask = MAX_HITBOX_SHAPES * 2 - 1;
+    Uint32 i = hash_id(id) & mask;
+    while (registry_index[i] && strcmp(registry_index[i]->label, id) != 0)
+        i = (i + 1) & mask;
+    return i;
+}
+
+// New registry entry for a label that has none yet
+static HitboxShape* add_shape(const HitboxShape* src, Uint32 slot) {
+    if (registry_count >= MAX_HITBOX_SHAPES) {
+        SDL_Log("Hitbox registry full, dropping %s", src->label);
+        return NULL;
+    }
+
+    HitboxShape* hs = &registry_shapes[registry_count];
+    hs->points = malloc(sizeof(SDL_Point) * src->point_count);
+    if (!hs->points) return NULL;
+    memcpy(hs->points, src->points, sizeof(SDL_Point) * src->point_count);
+    hs->point_count = src->point_count;
+    hs->source_point_count = src->source_point_count;
+    hs->radius = src->radius;
+    hs->layer = src->layer;
+    hs->mask = src->mask;
+    hs->label = strdup(src->label);
+    registry_count++;
+
+    registry_index[slot] = hs;
+    if (hs->source_point_count > hs->point_count)
+        printf("Hitbox %s: %d -> %d vertices\n", hs->label, hs->source_point_count, hs->point_count);
+    return hs;
+}
+
+void hitbox_registry_add_file(const HitboxFile* hf) {
+    if (!hf) return;
+
+    for (int i = 0; i < hf->shape_count; i++) {
+        const HitboxShape* src = &hf->shapes[i];
+        Uint32 slot = find_slot(src->label);
+        if (registry_index[slot]) continue;
+        if (!add_shape(src, slot)) return;
+    }
+}
+
+// Point a live collider at a (re)loaded shape, which may change its type
+static void set_collider_shape(ColliderComponent* c, const HitboxShape* hs) {
+    if (hs->radius > 0) {
+        c->type = COLLIDER_CIRCLE;
+        c->polygon.points = NULL;
+        c->polygon.point_count = 0;
+        c->circle.x = (float)hs->points[0].x;
+        c->circle.y = (float)hs->points[0].y;
+        c->circle.radius = hs->radius;
+    } else {
+        c->type = COLLIDER_POLYGON;
+        c->polygon.points = hs->points;
+        c->polygon.point_count = hs->point_count;
+    }
+}
+
+int hitbox_registry_reload_file(const HitboxFile* hf) {
+    if (!hf) return 0;
+
+    int updated = 0;
+    for (int i = 0; i < hf->shape_count; i++) {
+        const HitboxShape* src = &hf->shapes[i];
+        Uint32 slot = find_slot(src->label);
+        HitboxShape* hs = registry_index[slot];
+
+        if (!hs) {
+            // A new label: give it to live entities of that id
+            if (!add_shape(src, slot)) break;
+            for (int j = 0; j < sim.entity_count; j++) {
+                Entity* e = sim_entity(j);
+                const char* id = entity_cold(e)->id;
+                if (!sim_link(j)->in_use || !id || strcmp(id, src->label) != 0 || get_collider(e)) continue;
+                if (hitbox_registry_attach(e)) updated++;
+            }
+            continue;
+        }
+
+        SDL_Point* points = malloc(sizeof(SDL_Point) * src->point_count);
+        if (!points) continue;
+        memcpy(points, src->points, sizeof(SDL_Point) * src->point_count);
+
+        // Colliders share the registry polygon, so repoint every one of them
+        SDL_Point* old = hs->points;
+        hs->points = points;
+        hs->point_count = src->point_count;
+        hs->source_point_count = src->source_point_count;
+        hs->radius = src->radius;
+        hs->layer = src->layer;
+        hs->mask = src->mask;
+        for (int j = 0; j < sim.colliders.count; j++) {
+            ColliderComponent* c = &sim.colliders.items[j];
+            // Circles copy their geometry, so find those by the entity id
+            const char* id = entity_cold(sim_entity(c->entity))->id;
+            bool shared = c->type == COLLIDER_POLYGON ? c->polygon.points == old
+                                                      : id && strcmp(id, hs->label) == 0;
+            if (!shared) continue;
+            set_collider_shape(c, hs);
+            if (hs->layer) c->layer = hs->layer;
+            if (hs->mask) c->mask = hs->mask;
+            updated++;
+        }
+        free(old);
+    }
+
+    // Older snapshots still point at the freed geometry
+    sim_state_clear_history();
+    return updated;
+}
+
+const HitboxShape* hitbox_registry_find(const char* id) {
+    if (!id || registry_count == 0) return NULL;
+    return registry_index[find_slot(id)];
+}
+
+bool hitbox_registry_attach(Entity* e) {
+    return e && hitbox_registry_attach_as(e, entity_cold(e)->id);
+}
+
+bool hitbox_registry_attach_as(Entity* e, const char* label) {
+    if (!e) return false;
+    const HitboxShape* hs = hitbox_registry_find(label);
+    if (!hs) return false;
+    if (hs->radius > 0)
+        attach_circle_collider(e, (float)hs->points[0].x, (float)hs->points[0].y, hs->radius);
+    else
+        attach_polygon_collider(e, hs->points, hs->point_count);
+
+    // Data overrides the entity type's default filter
+    ColliderComponent* c = get_collider(e);
+    if (c && (hs->layer || hs->mask)) {
+        if (hs->layer) c->layer = hs->layer;
+        if (hs->mask) c->mask = hs->mask;
+    }
+    return true;
+}
+
+void hitbox_registry_clear(void) {
+    for (int i = 0; i < registry_count; i++) {
+        free(registry_shapes[i].label);
+        free(registry_shapes[i].points);
+    }
+    memset(registry_shapes, 0, sizeof(registry_shapes));
+    memset(registry_index, 0, sizeof(registry_index));
+    registry_count = 0;
+}
 
 // Called by nftw for each file
 static int collect_json_files(const char* fpath, const struct stat* sb, int typeflag, struct FTW* ftwbuf) {
@@ -20,47 +361,66 @@ static int collect_json_files(const char* fpath, const struct stat* sb, int type
     (void)ftwbuf;
 
     if (typeflag == FTW_F && strstr(fpath, ".json")) {
-        if (json_file_count < MAX_JSON_PATHS) {
-            json_file_paths[json_file_count++] = strdup(fpath);
+        char* path = strdup(fpath);
+        if (!path || !array_push(&json_files, path)) {
+            SDL_Log("Out of memory listing %s", fpath);
+            free(path);
+            return 1;   // stops the walk
         }
     }
     return 0;
 }
 
-void load_all_hitboxes(const char* hitbox_root, Entity** entities, int entity_count) {
-    json_file_count = 0;
+static void collect_all_json(const char* hitbox_root) {
+    json_files.count = 0;
     nftw(hitbox_root, collect_json_files, 10, FTW_PHYS);
+}
+
+static void free_collected_json(void) {
+    for (int i = 0; i < json_files.count; i++) {
+        free(json_files.items[i]);
+    }
+    json_files.count = 0;
+}
+
+void hitbox_prefetch_all(const char* hitbox_root) {
+    collect_all_json(hitbox_root);
+    for (int i = 0; i < json_files.count; i++) {
+        asset_request_hitbox(json_files.items[i]);
+    }
+    free_collected_json();
+}
+
+void hitbox_registry_build(const char* hitbox_root) {
+    collect_all_json(hitbox_root);
+
+    // Queue every file first so the pool parses them in parallel
+    for (int i = 0; i < json_files.count; i++) {
+        asset_request_hitbox(json_files.items[i]);
+    }
+
+    int before = registry_count;
+    for (int i = 0; i < json_files.count; i++) {
+        const HitboxFile* hf = asset_wait_hitbox(asset_request_hitbox(json_files.items[i]));
+        hitbox_registry_add_file(hf);
+    }
+
+    free_collected_json();
+
+    printf("Hitbox registry: %d shapes from %s\n", registry_count - before, hitbox_root);
+}
+
+void load_all_hitboxes(const char* hitbox_root, Entity** entities, int entity_count) {
+    if (registry_count == 0)
+        hitbox_registry_build(hitbox_root);
 
     for (int i = 0; i < entity_count; i++) {
         Entity* e = entities[i];
-        if (!e || !e->id) continue;
-
-        // Look for a matching JSON file
-        for (int j = 0; j < json_file_count; j++) {
-            const char* json_path = json_file_paths[j];
-            const char* filename = strrchr(json_path, '/');
-            if (!filename) filename = json_path; // No slash: file is in root
-            else filename++; // Skip the slash
-
-            // Match e->id to filename without ".json"
-            size_t id_len = strlen(e->id);
-            size_t fname_len = strlen(filename);
-            if (fname_len < 6 || strcmp(filename + fname_len - 5, ".json") != 0) continue;
-            if (strncmp(filename, e->id, id_len) != 0) continue;
-            if (filename[id_len] != '.' || strcmp(filename + id_len, ".json") != 0) continue;
-
-            // Match found, load the file
-            load_entity_hitbox(e, json_path);
-            printf("Loaded hitbox for entity ID: %s from %s\n", e->id, json_path);
-            break;  // stop after first match
-        }
-    }
+        if (!e || !entity_cold(e)->id || get_collider(e)) continue;
 
-    // Clean up collected file list
-    for (int i = 0; i < json_file_count; i++) {
-        free(json_file_paths[i]);
+        if (hitbox_registry_attach(e))
+            printf("Loaded hitbox for entity ID: %s\n", entity_cold(e)->id);
     }
-    json_file_count = 0;
 
     printf("Finished loading hitboxes for %d entities\n", entity_count);
 }
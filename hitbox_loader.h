@@ -1,9 +1,58 @@
 #ifndef HITBOX_LOADER_H
 #define HITBOX_LOADER_H
 
+#include <SDL.h>
+#include <stdbool.h>
 #include "entity.h"
 
-// Loads and attaches all hitboxes to matching entities
+#define HITBOX_DEFAULT_TOLERANCE 1.0f   // px; TANK_HITBOX_TOLERANCE overrides, 0 = off
+
+// One labelled shape from a labelme JSON file. A circle keeps its center
+// as the single point.
+typedef struct {
+    char* label;
+    SDL_Point* points;
+    int point_count;
+    float radius;           // > 0 for a circle
+    int source_point_count; // as clicked, before simplification
+    Uint32 layer, mask;     // from "layer:<name>"/"mask:<name>" shape flags, 0 = type default
+} HitboxShape;
+
+// Parsed contents of one hitbox JSON file (polygons and circles)
+typedef struct {
+    HitboxShape* shapes;
+    int shape_count;
+} HitboxFile;
+
+// Parse a labelme JSON file; safe to call from worker threads. Outlines are
+// simplified (Douglas-Peucker) to the tolerance unless the shape has the
+// "exact" flag.
+bool hitbox_file_parse(const char* json_path, HitboxFile* out);
+void hitbox_file_free(HitboxFile* hf);
+
+// Maximum deviation in px from TANK_HITBOX_TOLERANCE; 0 disables simplification
+float hitbox_simplify_tolerance(void);
+
+// Registry: label -> immutable local polygon, shared by every instance.
+// The first shape registered for a label wins.
+void hitbox_registry_add_file(const HitboxFile* hf);
+void hitbox_registry_build(const char* hitbox_root);
+const HitboxShape* hitbox_registry_find(const char* id);
+bool hitbox_registry_attach(Entity* e);
+// The shape registered under label, whatever the entity's own id
+bool hitbox_registry_attach_as(Entity* e, const char* label);
+void hitbox_registry_clear(void);
+
+// Hot reload: replace the geometry of every label in a re-parsed file and
+// repoint the colliders that share it; new labels are attached to live
+// entities with that id. The latest file wins, unlike at build time.
+// Drops the rollback history. Returns the number of colliders touched.
+int hitbox_registry_reload_file(const HitboxFile* hf);
+
+// Queue every JSON under hitbox_root for parsing on the asset loader pool
+void hitbox_prefetch_all(const char* hitbox_root);
+
+// Builds the registry if needed and attaches hitboxes to entities that lack one
 void load_all_hitboxes(const char* hitbox_root, Entity** entities, int entity_count);
 
 #endif
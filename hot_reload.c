@@ -0,0 +1,273 @@
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include <SDL_image.h>
+#include "hot_reload.h"
+#include "asset_loader.h"
+#include "hitbox_loader.h"
+#include "dirty_rects.h"
+
+bool hot_reload_wanted(void) {
+    const char* env = SDL_getenv("TANK_HOT_RELOAD");
+    return env && atoi(env) != 0;
+}
+
+#ifdef __linux__
+
+#include <ftw.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define HOT_RELOAD_POLL_MS 100      // how often the watcher checks for shutdown
+
+typedef struct {
+    int wd;
+    char* dir;
+    bool hitboxes;
+} Watch;
+
+// One changed file, decoded and waiting for the main thread
+typedef struct {
+    char* path;
+    bool is_hitbox;
+    SDL_Surface* surface;
+    HitboxFile hitbox;
+    Uint32 changed_at;          // SDL_GetTicks when the write landed
+} Reload;
+
+static int inotify_fd = -1;
+static Watch watches[HOT_RELOAD_MAX_WATCHES];
+static int watch_count = 0;             // the watcher thread appends after init
+static bool walk_hitboxes = false;      // nftw callback has no user pointer
+
+static SDL_Thread* watcher = NULL;
+static SDL_atomic_t quit;
+
+static Reload pending[HOT_RELOAD_MAX_PENDING];
+static int pending_count = 0;
+static SDL_mutex* pending_lock = NULL;
+
+static void add_watch(const char* dir, bool hitboxes) {
+    if (watch_count >= HOT_RELOAD_MAX_WATCHES) {
+        SDL_Log("Hot reload: too many directories, not watching %s", dir);
+        return;
+    }
+    int wd = inotify_add_watch(inotify_fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    if (wd < 0) {
+        SDL_Log("Hot reload: cannot watch %s", dir);
+        return;
+    }
+    watches[watch_count++] = (Watch){ wd, strdup(dir), hitboxes };
+}
+
+static int watch_dir_cb(const char* fpath, const struct stat* sb, int typeflag, struct FTW* ftwbuf) {
+    (void)sb;
+    (void)ftwbuf;
+    if (typeflag == FTW_D) add_watch(fpath, walk_hitboxes);
+    return 0;
+}
+
+static void watch_tree(const char* root, bool hitboxes) {
+    walk_hitboxes = hitboxes;
+    nftw(root, watch_dir_cb, 10, FTW_PHYS);
+}
+
+static const Watch* find_watch(int wd) {
+    for (int i = 0; i < watch_count; i++) {
+        if (watches[i].wd == wd) return &watches[i];
+    }
+    return NULL;
+}
+
+static bool has_suffix(const char* s, const char* suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && SDL_strcasecmp(s + n - m, suffix) == 0;
+}
+
+static void free_reload(Reload* r) {
+    if (r->surface) SDL_FreeSurface(r->surface);
+    hitbox_file_free(&r->hitbox);
+    free(r->path);
+    memset(r, 0, sizeof(*r));
+}
+
+// Queue a decoded file; a newer save of the same path replaces the older one
+static void push_reload(Reload* r) {
+    SDL_LockMutex(pending_lock);
+    Reload* slot = NULL;
+    for (int i = 0; i < pending_count; i++) {
+        if (strcmp(pending[i].path, r->path) == 0) {
+            free_reload(&pending[i]);
+            slot = &pending[i];
+            break;
+        }
+    }
+    if (!slot && pending_count < HOT_RELOAD_MAX_PENDING)
+        slot = &pending[pending_count++];
+    if (slot) *slot = *r;
+    SDL_UnlockMutex(pending_lock);
+
+    if (!slot) {
+        SDL_Log("Hot reload: queue full, dropping %s", r->path);
+        free_reload(r);
+    }
+}
+
+// Runs on the watcher thread: decode right away, the main thread only swaps
+static void handle_event(const struct inotify_event* ev) {
+    const Watch* w = find_watch(ev->wd);
+    if (!w || ev->len == 0 || ev->name[0] == '.') return;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", w->dir, ev->name);
+
+    if (ev->mask & IN_ISDIR) {
+        if (ev->mask & (IN_CREATE | IN_MOVED_TO)) add_watch(path, w->hitboxes);
+        return;
+    }
+    if (!(ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) return;
+
+    Reload r = { 0 };
+    r.changed_at = SDL_GetTicks();
+    if (w->hitboxes && has_suffix(ev->name, ".json")) {
+        if (!hitbox_file_parse(path, &r.hitbox)) {
+            SDL_Log("Hot reload: cannot parse %s", path);
+            return;
+        }
+        r.is_hitbox = true;
+    } else if (!w->hitboxes && (has_suffix(ev->name, ".png") || has_suffix(ev->name, ".jpg") ||
+                                has_suffix(ev->name, ".bmp"))) {
+        r.surface = IMG_Load(path);
+        if (!r.surface) {
+            SDL_Log("Hot reload: IMG_Load failed for %s: %s", path, IMG_GetError());
+            return;
+        }
+    } else {
+        return;     // editor swap files and the like
+    }
+    r.path = strdup(path);
+    push_reload(&r);
+}
+
+static int watcher_main(void* arg) {
+    (void)arg;
+    _Alignas(struct inotify_event) char buf[4096];
+
+    while (!SDL_AtomicGet(&quit)) {
+        struct pollfd pfd = { inotify_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, HOT_RELOAD_POLL_MS) <= 0) continue;
+
+        ssize_t len = read(inotify_fd, buf, sizeof(buf));
+        const struct inotify_event* ev;
+        for (char* p = buf; len > 0 && p < buf + len; p += sizeof(struct inotify_event) + ev->len) {
+            ev = (const struct inotify_event*)p;
+            handle_event(ev);
+        }
+    }
+    return 0;
+}
+
+bool hot_reload_init(const char* asset_root, const char* hitbox_root) {
+    if (watcher) return true;
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        SDL_Log("Hot reload unavailable: inotify_init1 failed");
+        return false;
+    }
+    pending_lock = SDL_CreateMutex();
+    if (!pending_lock) {
+        SDL_Log("Hot reload init failed: %s", SDL_GetError());
+        hot_reload_shutdown();
+        return false;
+    }
+
+    watch_tree(asset_root, false);
+    watch_tree(hitbox_root, true);
+
+    SDL_AtomicSet(&quit, 0);
+    watcher = SDL_CreateThread(watcher_main, "hot_reload", NULL);
+    if (!watcher) {
+        SDL_Log("Failed to start hot reload watcher: %s", SDL_GetError());
+        hot_reload_shutdown();
+        return false;
+    }
+    SDL_Log("Hot reload: watching %d directories under %s and %s", watch_count, asset_root, hitbox_root);
+    return true;
+}
+
+void hot_reload_shutdown(void) {
+    if (watcher) {
+        SDL_AtomicSet(&quit, 1);
+        SDL_WaitThread(watcher, NULL);
+        watcher = NULL;
+    }
+    if (inotify_fd >= 0) close(inotify_fd);
+    inotify_fd = -1;
+
+    for (int i = 0; i < watch_count; i++)
+        free(watches[i].dir);
+    watch_count = 0;
+
+    for (int i = 0; i < pending_count; i++)
+        free_reload(&pending[i]);
+    pending_count = 0;
+    if (pending_lock) SDL_DestroyMutex(pending_lock);
+    pending_lock = NULL;
+}
+
+int hot_reload_apply(SDL_Renderer* renderer) {
+    if (!pending_lock) return 0;
+
+    Reload batch[HOT_RELOAD_MAX_PENDING];
+    SDL_LockMutex(pending_lock);
+    int count = pending_count;
+    memcpy(batch, pending, sizeof(Reload) * count);
+    pending_count = 0;
+    SDL_UnlockMutex(pending_lock);
+
+    int applied = 0;
+    for (int i = 0; i < count; i++) {
+        Reload* r = &batch[i];
+        int touched;
+        if (r->is_hitbox) {
+            touched = hitbox_registry_reload_file(&r->hitbox);
+        } else {
+            // Takes the surface; -1 means nothing ever loaded this path
+            touched = asset_replace_image(renderer, r->path, r->surface);
+            r->surface = NULL;
+        }
+        if (touched >= 0) {
+            SDL_Log("Hot reload: %s, %d %s updated (%u ms after the write)", r->path, touched,
+                    r->is_hitbox ? "colliders" : "textures", SDL_GetTicks() - r->changed_at);
+            applied++;
+        }
+        free_reload(r);
+    }
+
+    // Same-size textures change in place, which the dirty-rect diff cannot see
+    if (applied) dirty_rects_invalidate();
+    return applied;
+}
+
+#else
+
+bool hot_reload_init(const char* asset_root, const char* hitbox_root) {
+    (void)asset_root;
+    (void)hitbox_root;
+    SDL_Log("Hot reload needs inotify (Linux)");
+    return false;
+}
+
+void hot_reload_shutdown(void) {
+}
+
+int hot_reload_apply(SDL_Renderer* renderer) {
+    (void)renderer;
+    return 0;
+}
+
+#endif
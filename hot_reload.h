@@ -0,0 +1,25 @@
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define HOT_RELOAD_MAX_WATCHES 64       // directories, including subdirectories
+#define HOT_RELOAD_MAX_PENDING 64       // decoded files waiting for a frame boundary
+
+// Development aid: watch the asset and hitbox trees with inotify and
+// reload files as they are saved. Only the changed file is decoded, on a
+// watcher thread; hot_reload_apply swaps the result in between frames.
+// Linux only; elsewhere init reports false and apply does nothing.
+bool hot_reload_init(const char* asset_root, const char* hitbox_root);
+void hot_reload_shutdown(void);
+
+// True when TANK_HOT_RELOAD is set to a non-zero value
+bool hot_reload_wanted(void);
+
+// Main thread, at a frame boundary: swap every file decoded since the
+// last call into the textures and colliders that use it. Returns the
+// number of files applied.
+int hot_reload_apply(SDL_Renderer* renderer);
+
+#endif
@@ -2,6 +2,8 @@
 #include <SDL_image.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "entity.h"
 #include "mount_system.h"
@@ -13,66 +15,462 @@
 #include "bullet.h"
 #include "hitbox_loader.h"
 #include "collision.h"
+#include "asset_loader.h"
+#include "asset_pack.h"
+#include "camera.h"
+#include "world_chunks.h"
+#include "particles.h"
+#include "animation_system.h"
+#include "rotation_cache.h"
+#include "dirty_rects.h"
+#include "player_tank.h"
+#include "net_udp.h"
+#include "net_server.h"
+#include "net_client.h"
+#include "sim_state.h"
+#include "navigation.h"
+#include "spatial_query.h"
+#include "hot_reload.h"
+#include "frame_pacing.h"
+#include "command_buffer.h"
 
 #define WINDOW_WIDTH  1000
 #define WINDOW_HEIGHT 750
-#define FIXED_DT (1.0f / 60.0f)
-bool space_pressed = false;
-float shoot_cooldown = 0.0f;
-const float SHOOT_COOLDOWN_TIME = 0.2f; // 200ms between shots
+#define WORLD_WIDTH   3000
+#define WORLD_HEIGHT  2250
+#define BENCH_DEFAULT_TICKS 3600
+#define BENCH_AI_TANKS 16
+#define AI_TANK_SPACING 210.0f      // a sprite apart, so hulls never start overlapping
+static const SDL_Color BACKGROUND = { 10, 10, 10, 255 };
+
+// TANK_AI_TANKS=<n>: tanks that chase the player along one shared flow field
+static ARRAY(Entity*) ai_tanks;
+static ARRAY(int) ai_fields;
+static ARRAY(Camera) ai_views;      // the player's and one per tank, for chunk streaming
+
+typedef struct {
+    Entity* tank;               // NULL when the network client draws the tanks
+    Entity** all_entities;
+    int entity_count;
+    Entity** scenery;
+    int scenery_count;
+} SceneRefs;
+
+// Everything drawn in a frame, in order. Dirty-rect mode calls this once to
+// record and once per dirty region, so it must not clear or present.
+static void draw_scene(SDL_Renderer* renderer, void* ctx) {
+    SceneRefs* scene = ctx;
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    if (scene->tank) {
+        entity_render(renderer, scene->tank, scene->tank->width, scene->tank->height);
+        world_chunks_render(renderer);
+        for (int i = 0; i < ai_tanks.count; i++)
+            entity_render(renderer, ai_tanks.items[i], ai_tanks.items[i]->width, ai_tanks.items[i]->height);
+        mount_render_all(renderer, scene->tank);
+        render_all_bullets(renderer);
+    } else {
+        world_chunks_render(renderer);
+        net_client_render(renderer);
+    }
+    particles_render_all(renderer);
+
+    // Debug polygon lines
+    draw_all_collision_polygons(renderer, scene->all_entities, scene->entity_count);
+    draw_all_collision_polygons(renderer, scene->scenery, scene->scenery_count);
+}
+
+// One deterministic step of the local game: everything it touches is in sim.
+// Chunk streaming follows the tank rather than the smoothed camera so that a
+// resimulated tick loads and unloads exactly what the live one did.
+static float simulate_tick(PlayerTank* player, SDL_Renderer* renderer, Uint8 input) {
+    player_tank_control(player, input, FIXED_DT);
+
+    // Agents check their line of sight against the grid, so it reflects the
+    // tick's starting state: the same after a live tick and after a restore
+    if (ai_tanks.count > 0) spatial_rebuild();
+    nav_steer_agents(ai_tanks.items, ai_fields.items, ai_tanks.count, FIXED_DT);
+    for (int i = 0; i < ai_tanks.count; i++)
+        entity_update(ai_tanks.items[i], NULL, FIXED_DT);
+
+    // Scenery streams around the player and around every agent, so agents
+    // far from the player still have rocks to collide with. spawn_ai_tanks
+    // reserved a view per tank.
+    Camera player_view;
+    Camera* views = ai_views.capacity > ai_tanks.count ? ai_views.items : &player_view;
+    camera_init(&views[0], WINDOW_WIDTH, WINDOW_HEIGHT);
+    views[0].x = player->tank->x;
+    views[0].y = player->tank->y;
+    for (int i = 0; i < ai_tanks.count; i++) {
+        camera_init(&views[i + 1], 0, 0);
+        views[i + 1].x = ai_tanks.items[i]->x;
+        views[i + 1].y = ai_tanks.items[i]->y;
+    }
+    world_chunks_update_views(views, ai_tanks.count + 1);
+
+    // ---- Physics ----
+    player_tank_step(player, FIXED_DT);
+    update_all_bullets(FIXED_DT);
+    // Everything that touches: rocks (only loaded chunks have entities),
+    // bullets, AI tanks, tank against tank. Handlers queue their spawns and
+    // destroys for the apply below.
+    handle_all_collisions(FIXED_DT);
+    float impact = player_tank_settle(player, FIXED_DT);
+
+    // Sync point: spawns and destroys queued during the tick land here
+    command_apply(renderer);
+    sim.tick++;
+    return impact;
+}
+
+// TANK_ROLLBACK_CHECK: rewind `depth` ticks, replay the recorded inputs and
+// compare against the live result. Exercises the snapshot ring every tick and
+// reports what a rollback of that depth costs.
+static void rollback_check(PlayerTank* player, SDL_Renderer* renderer, const Uint8* inputs, int depth) {
+    static SimState live;
+    static Uint64 total_ticks = 0, total_checks = 0;
+    Uint32 now_tick = sim.tick;
+    if (now_tick < (Uint32)depth) return;
+
+    if (!sim_state_copy(&live, &sim)) return;
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (!sim_state_restore(now_tick - depth)) return;
+    while (sim.tick < now_tick)
+        simulate_tick(player, renderer, inputs[sim.tick % SIM_ROLLBACK_FRAMES]);
+    total_ticks += SDL_GetPerformanceCounter() - start;
+    total_checks++;
+
+    for (int i = 0; i < live.entity_count; i++) {
+        const Entity* a = pool_at(&live.entities, i);
+        const Entity* b = sim_entity(i);
+        if (pool_at(&live.links, i)->in_use != sim_link(i)->in_use ||
+            a->x != b->x || a->y != b->y || a->angle != b->angle || a->speed != b->speed) {
+            const char* id = entity_cold(b)->id;
+            SDL_Log("Rollback mismatch at tick %u, slot %d (%s)", now_tick, i, id ? id : "?");
+            break;
+        }
+    }
+
+    if (total_checks % 300 == 0) {
+        double us = 1e6 * (double)total_ticks / (double)SDL_GetPerformanceFrequency() / (double)total_checks;
+        SDL_Log("Rollback %d ticks: %.1f us avg (state %u bytes)", depth, us, (unsigned)sim_state_bytes(&sim));
+    }
+}
+
+static int ai_tanks_wanted(void) {
+    const char* env = SDL_getenv("TANK_AI_TANKS");
+    return env ? atoi(env) : 0;
+}
+
+static void spawn_ai_tanks(SDL_Renderer* renderer, const Entity* target, int wanted) {
+    if (wanted <= 0) return;
+    if (!array_reserve(&ai_tanks, wanted) || !array_reserve(&ai_fields, wanted) ||
+        !array_reserve(&ai_views, wanted + 1)) {
+        SDL_Log("Out of memory for %d AI tanks", wanted);
+        return;
+    }
+
+    int field = nav_field_create(target->x, target->y);
+    if (field < 0) return;
+
+    // Rows across the world from the far corner, so the first ones have
+    // rocks to path around. Spots on rocks or next to the player are skipped.
+    float half = AI_TANK_SPACING / 2;
+    int columns = (int)(WORLD_WIDTH / AI_TANK_SPACING);
+    int spots = columns * (int)(WORLD_HEIGHT / AI_TANK_SPACING);
+    int spot = 0;
+    for (; spot < spots && ai_tanks.count < wanted; spot++) {
+        float x = WORLD_WIDTH - half - (spot % columns) * AI_TANK_SPACING;
+        float y = WORLD_HEIGHT - half - (spot / columns) * AI_TANK_SPACING;
+        float dx = x - target->x, dy = y - target->y;
+        if (dx * dx + dy * dy < 4 * AI_TANK_SPACING * AI_TANK_SPACING) continue;
+        if (!nav_area_open(x, y, half)) continue;
+
+        Entity* e = spawn_entity("ai_tank", renderer, "assets/tank.png", x, y);
+        if (!e) break;
+        hitbox_registry_attach_as(e, "tank");
+        e->max_speed = 150;
+        entity_set_angle(e, 180.0f);
+        ai_tanks.items[ai_tanks.count++] = e;
+        ai_fields.items[ai_fields.count++] = field;
+    }
+    if (ai_tanks.count < wanted && spot == spots)
+        SDL_Log("Placed %d of %d AI tanks: no open ground left", ai_tanks.count, wanted);
+    SDL_Log("%d AI tanks following flow field %d", ai_tanks.count, field);
+}
+
+// The entities go with the pool; only the lists are ours
+static void cleanup_ai_tanks(void) {
+    array_free(&ai_tanks);
+    array_free(&ai_fields);
+    array_free(&ai_views);
+}
+
+// Queue every decode up front; spawns wait on their own futures. Every
+// hitbox is indexed once and spawns pick up their collider by id.
+static void load_assets(SDL_Renderer* renderer) {
+    asset_loader_init(renderer, 0);
+    hitbox_prefetch_all("hitboxes");
+    asset_request_image("assets/rock.png");
+    player_tank_prefetch();
+    hitbox_registry_build("hitboxes");
+}
+
+// Built-in bench workload when no replay is given: drive, turn both ways,
+// fire and swing the turret, in phases long enough to reach rocks and walls
+static Uint8 bench_script_input(Uint32 tick) {
+    Uint32 phase = (tick / 90) % 8;
+    Uint8 in = PLAYER_IN_THRUST;
+    if (phase == 1 || phase == 5) in |= PLAYER_IN_LEFT;
+    if (phase == 3) in |= PLAYER_IN_RIGHT | PLAYER_IN_AFTERBURNER;
+    if (phase == 6) in = PLAYER_IN_RIGHT;
+    if (phase == 2 || phase == 7) in |= PLAYER_IN_TURRET_RIGHT;
+    if (phase == 4) in |= PLAYER_IN_TURRET_LEFT;
+    if (tick % 20 < 2) in |= PLAYER_IN_FIRE;
+    if (tick % 600 == 300) in |= PLAYER_IN_TURRET_TOGGLE;
+    return in;
+}
+
+// One input byte per tick, as written by TANK_RECORD; NULL if unreadable
+static Uint8* load_replay(const char* path, long* length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    Uint8* data = len > 0 ? malloc(len) : NULL;
+    if (data && fread(data, 1, len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *length = len;
+    return data;
+}
+
+// --bench [ticks]: the local game without a window or pacing. Simulation,
+// collisions, mounts, AI steering and the software render of every frame
+// run exactly as they do live, driven by TANK_REPLAY=<file> (looped) or by
+// the built-in script. Deterministic, so it doubles as the PGO training run;
+// the state hash at the end must match between builds.
+static int run_bench(int ticks) {
+    SDL_Surface* target = NULL;
+    SDL_Renderer* renderer = NULL;
+    if (!init_sdl_headless(&target, &renderer, WINDOW_WIDTH, WINDOW_HEIGHT)) return 1;
+
+    bullet_system_init();
+    world_set_bounds(WORLD_WIDTH, WORLD_HEIGHT);
+    nav_init(NAV_CELL_SIZE);
+    Camera camera;
+    camera_init(&camera, WINDOW_WIDTH, WINDOW_HEIGHT);
+    camera_set_active(&camera);
+    load_assets(renderer);
+
+    PlayerTank player = { 0 };
+    if (!player_tank_spawn(&player, renderer, 100, 100)) {
+        shutdown_game(NULL, renderer, NULL, 0);
+        SDL_FreeSurface(target);
+        return 1;
+    }
+    Entity* all_entities[] = { player.tank, player.turret, player.flame, player.right_burner, player.left_burner };
+    int entity_count = (int)(sizeof(all_entities) / sizeof(all_entities[0]));
+    world_chunks_init(renderer, "maps/rocks");
+
+    long replay_len = 0;
+    const char* replay_path = SDL_getenv("TANK_REPLAY");
+    Uint8* replay = replay_path ? load_replay(replay_path, &replay_len) : NULL;
+    if (replay_path && !replay) SDL_Log("Cannot read replay %s, using the built-in script", replay_path);
+
+    // A replay gets the AI tanks of the session it came from (TANK_AI_TANKS)
+    int wanted = ai_tanks_wanted();
+    if (!replay && wanted <= 0) wanted = BENCH_AI_TANKS;
+    spawn_ai_tanks(renderer, player.tank, wanted);
+
+    Uint64 sim_ticks = 0, render_ticks = 0;
+    for (int i = 0; i < ticks; i++) {
+        Uint8 input = replay ? replay[i % replay_len] : bench_script_input(sim.tick);
+
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        simulate_tick(&player, renderer, input);
+        camera_follow(&camera, player.tank, 8.0f, FIXED_DT);
+        if (ai_fields.count) nav_field_set_goal(ai_fields.items[0], player.tank->x, player.tank->y);
+        nav_update(NAV_DEFAULT_BUDGET);
+        animation_tick(1000.0f * FIXED_DT);
+
+        Uint64 t1 = SDL_GetPerformanceCounter();
+        SceneRefs scene = { player.tank, all_entities, entity_count, NULL, 0 };
+        scene.scenery = world_chunks_gather(&scene.scenery_count);
+        SDL_SetRenderDrawColor(renderer, BACKGROUND.r, BACKGROUND.g, BACKGROUND.b, BACKGROUND.a);
+        SDL_RenderClear(renderer);
+        draw_scene(renderer, &scene);
+        SDL_RenderPresent(renderer);
+        Uint64 t2 = SDL_GetPerformanceCounter();
+
+        sim_ticks += t1 - t0;
+        render_ticks += t2 - t1;
+    }
+
+    // FNV-1a over every live entity's position and angle
+    Uint32 hash = 2166136261u;
+    for (int i = 0; i < sim.entity_count; i++) {
+        if (!sim_link(i)->in_use) continue;
+        const Entity* e = sim_entity(i);
+        float v[3] = { e->x, e->y, e->angle };
+        const Uint8* b = (const Uint8*)v;
+        for (size_t k = 0; k < sizeof(v); k++) {
+            hash ^= b[k];
+            hash *= 16777619u;
+        }
+    }
+
+    double us = 1e6 / (double)SDL_GetPerformanceFrequency() / (double)(ticks > 0 ? ticks : 1);
+    printf("bench: %d ticks (%s), %.1f us/tick: sim %.1f, render %.1f; state %08x\n",
+           ticks, replay ? replay_path : "script", us * (double)(sim_ticks + render_ticks),
+           us * (double)sim_ticks, us * (double)render_ticks, (unsigned)hash);
+
+    free(replay);
+    player_tank_destroy(&player);
+    cleanup_bullet_system();
+    world_chunks_shutdown();
+    nav_shutdown();
+    cleanup_ai_tanks();
+    spatial_shutdown();
+    shutdown_game(NULL, renderer, NULL, 0);
+    SDL_FreeSurface(target);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // --server [port]: headless simulation; --connect host[:port]: render client;
+    // --bench [ticks]: headless timing run; --build-pack [file]: write the asset pack
+    const char* connect_to = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--server") == 0) {
+            Uint16 port = (i + 1 < argc) ? (Uint16)atoi(argv[i + 1]) : 0;
+            return net_server_run(port ? port : NET_DEFAULT_PORT, WORLD_WIDTH, WORLD_HEIGHT);
+        }
+        if (strcmp(argv[i], "--bench") == 0) {
+            int ticks = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            return run_bench(ticks > 0 ? ticks : BENCH_DEFAULT_TICKS);
+        }
+        if (strcmp(argv[i], "--build-pack") == 0) {
+            const char* pack = (i + 1 < argc) ? argv[i + 1] : ASSET_PACK_DEFAULT_PATH;
+            return asset_pack_build(pack, "assets", "hitboxes") ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc)
+            connect_to = argv[++i];
+    }
 
-int main() {
     SDL_Window* window = NULL;
     SDL_Renderer* renderer = NULL;
     if (!init_sdl(&window, &renderer, WINDOW_WIDTH, WINDOW_HEIGHT)) return 1;
 
-    Entity* entities[4];
-    int entity_count = 0;
     bullet_system_init();
 
-    // 1. Load entities
-    // ---- Rock Setup ----
-    REGISTER_ENTITY(rock, spawn_entity("rock", renderer, "assets/rock.png", 800, 600));
-    
-    // ---- Tank Setup ----
-    REGISTER_ENTITY(tank, spawn_entity("tank", renderer, "assets/tank.png", 100, 100));
-    
-    // Initialize mount system for tank
-    mount_system_init(tank, 4);
-    
-    // ---- Turret Setup ----
-    REGISTER_ENTITY(turret, spawn_entity("turret", renderer, "assets/turret.png", 0, 0));
-    register_mount_and_attach(tank, "main_weapon", -1, 40, 50, 0.0f, true, 0.0f, turret);
-
-    // Exhaust Flame Component
-    REGISTER_ANIMATED_ENTITY(flame, spawn_animated_entity("main_motor_flame", renderer, "assets/exhaust-flame", 4, 0, 0));
-    register_mount_and_attach_animated(tank, "exhaust_flame", -1, -90, 0, 0.0f, true, 0.0f, flame);
-
-    REGISTER_ANIMATED_ENTITY(right_burner, spawn_animated_entity("burner_right", renderer, "assets/burner", 16, 0, 0))
-    register_mount_and_attach_animated(tank, "right_burner", -1, -50, -78, 0.0f, true, 0.0f, right_burner);
-    REGISTER_ANIMATED_ENTITY(left_burner, spawn_animated_entity("burner_left", renderer, "assets/burner", 16, 0, 0))
-    register_mount_and_attach_animated(tank, "left_burner", -1, -50, +78, 0.0f, true, 0.0f, left_burner);  
+    world_set_bounds(WORLD_WIDTH, WORLD_HEIGHT);
+    nav_init(NAV_CELL_SIZE);
+    Camera camera;
+    camera_init(&camera, WINDOW_WIDTH, WINDOW_HEIGHT);
+    camera_set_active(&camera);
+
+    // CPU-only hosts: pre-rotate sprites instead of rotating every blit
+    int rotation_steps;
+    if (rotation_cache_wanted(renderer, &rotation_steps))
+        rotation_cache_init(rotation_steps, ROTATION_CACHE_DEFAULT_BUDGET);
+
+    // Opt-in: redraw only what changed since the last frame
+    if (dirty_rects_wanted())
+        dirty_rects_init(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, BACKGROUND);
+
+    // 0. Decodes and the hitbox registry, before anything spawns
+    load_assets(renderer);
+
+    // Opt-in: saved sprites and hitboxes replace the loaded ones in place
+    if (hot_reload_wanted())
+        hot_reload_init("assets", "hitboxes");
+
+    // 1. Our tank, or the server's tanks once snapshots arrive
+    PlayerTank player = { 0 };
+    Entity* tank = NULL;
+    if (connect_to) {
+        if (!net_client_connect(connect_to, NET_DEFAULT_PORT)) {
+            shutdown_game(window, renderer, NULL, 0);
+            return 1;
+        }
+    } else {
+        if (!player_tank_spawn(&player, renderer, 100, 100)) {
+            shutdown_game(window, renderer, NULL, 0);
+            return 1;
+        }
+        tank = player.tank;
+    }
 
     Entity* all_entities[] = {
-    rock,
-    tank,
-    turret,
-    &flame->base,
-    &right_burner->base,
-    &left_burner->base};
-
-    entity_count = sizeof(all_entities) / sizeof(all_entities[0]);
-
-    // 2. Load hitboxes from anywhere inside hitboxes/
-    load_all_hitboxes("hitboxes", all_entities, entity_count);
-    debug_collision_info(tank);
-    debug_collision_info(rock);
- 
+    player.tank,
+    player.turret,
+    player.flame,
+    player.right_burner,
+    player.left_burner};
+
+    int entity_count = tank ? (int)(sizeof(all_entities) / sizeof(all_entities[0])) : 0;
+
+    // 2. Hitboxes were attached at spawn from the registry
+    if (tank) debug_collision_info(tank);
+
+    // 3. Rocks stream in per chunk around the camera
+    world_chunks_init(renderer, "maps/rocks");
+    world_chunks_update(&camera);
+    if (tank) spawn_ai_tanks(renderer, tank, ai_tanks_wanted());
+
+    // 4. Particle effects: exhaust smoke on the flame mount, sparks on impact
+    SDL_Texture* particle_texture = particle_texture_create(renderer, 8);
+    EmitterConfig smoke_cfg = {
+        .rate = 90.0f, .speed_min = 40.0f, .speed_max = 90.0f,
+        .spread_deg = 12.0f, .angle_offset = 180.0f,
+        .life_min = 0.6f, .life_max = 1.2f,
+        .size_start = 10.0f, .size_end = 34.0f, .drag = 1.5f,
+        .color_start = { 150, 140, 130, 160 }, .color_end = { 60, 60, 60, 0 },
+        .blend = SDL_BLENDMODE_BLEND
+    };
+    EmitterConfig spark_cfg = {
+        .rate = 0.0f, .speed_min = 120.0f, .speed_max = 320.0f,
+        .spread_deg = 180.0f, .angle_offset = 0.0f,
+        .life_min = 0.2f, .life_max = 0.5f,
+        .size_start = 6.0f, .size_end = 1.0f, .drag = 3.0f,
+        .color_start = { 255, 220, 120, 255 }, .color_end = { 255, 80, 0, 0 },
+        .blend = SDL_BLENDMODE_ADD
+    };
+    ParticleEmitter* smoke = particle_emitter_create(&smoke_cfg, particle_texture, 512);
+    ParticleEmitter* sparks = particle_emitter_create(&spark_cfg, particle_texture, 1024);
+    if (smoke && tank) {
+        particle_emitter_attach(smoke, tank, "exhaust_flame");
+        player.smoke = smoke;
+    }
+
+    // Inputs of the last SIM_ROLLBACK_FRAMES ticks, for resimulation
+    Uint8 recorded_inputs[SIM_ROLLBACK_FRAMES] = { 0 };
+    int rollback_depth = connect_to ? 0 : sim_rollback_check_depth();
+    if (rollback_depth && ai_tanks.count) {
+        // Flow fields are derived data outside SimState and keep integrating
+        // between ticks, so replayed steering would not match
+        SDL_Log("Rollback check disabled with AI tanks");
+        rollback_depth = 0;
+    }
+    if (rollback_depth)
+        SDL_Log("Rollback check: %d ticks every tick", rollback_depth);
+
+    // TANK_RECORD=<file>: one input byte per tick, replayable with --bench
+    const char* record_path = connect_to ? NULL : SDL_getenv("TANK_RECORD");
+    FILE* record = record_path ? fopen(record_path, "wb") : NULL;
+    if (record_path && !record) SDL_Log("Cannot record to %s", record_path);
+
+    // One frame per sim tick. TANK_LOW_LATENCY=1 waits before sampling
+    // input instead of after present; TANK_LATENCY_REPORT=1 logs latency.
+    frame_pacing_init(renderer, 1000.0 * FIXED_DT, frame_pacing_low_latency_wanted(),
+                      frame_pacing_report_wanted());
+
     // ---- Main Loop ----
     bool running = true;
-    bool turret_mounted = true;
-    bool turret_toggle_pressed = false;
-    float turret_remount_cooldown = 0.5f;  // in seconds
     Uint32 last_time = SDL_GetTicks();
 
     while (running) {
@@ -80,7 +478,13 @@ int main() {
 	Uint32 now = SDL_GetTicks();
         float delta_ms = now - last_time;
         last_time = now;
+        // Frame boundary: nothing holds a texture or hitbox pointer mid-use
+        hot_reload_apply(renderer);
+
+        // Input is sampled from here on
+        frame_pacing_before_input();
         while (SDL_PollEvent(&e)) {
+            frame_pacing_event(&e);
             if (e.type == SDL_QUIT ||
                (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)) {
                 running = false;
@@ -88,96 +492,63 @@ int main() {
         }
 
         const Uint8* keystate = SDL_GetKeyboardState(NULL);
-	apply_thrust_turn(tank, keystate, SDL_SCANCODE_UP, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, 1.0, 180, FIXED_DT);
-	apply_afterburner(tank, keystate, SDL_SCANCODE_Z, 8, FIXED_DT);
-	
-        bool moving = keystate[SDL_SCANCODE_UP];
-        bool afterburner_on= keystate[SDL_SCANCODE_Z];
-	bool turning_left  = keystate[SDL_SCANCODE_LEFT]; 
-        bool turning_right = keystate[SDL_SCANCODE_RIGHT];
-
-        flame->base.active = moving || afterburner_on;
-	left_burner->base.active  = turning_left || afterburner_on;
-	right_burner->base.active = turning_right || afterburner_on;
-
-	toggle_mount_with_key(turret, tank, "main_weapon", SDL_SCANCODE_T, &turret_mounted, &turret_toggle_pressed, &turret_remount_cooldown, 0.5f, FIXED_DT);
-
-	rotate_within_limits(tank, "main_weapon", keystate, SDL_SCANCODE_A, SDL_SCANCODE_D, -20, 20, 4.0f, FIXED_DT);
-        /* rotate_infinite(tank, "main_weapon", keystate, SDL_SCANCODE_A, SDL_SCANCODE_D, 1.0f, FIXED_DT); */
-
-	// bullet shoot
-	shoot_cooldown -= FIXED_DT;
-        if (shoot_cooldown < 0.0f) shoot_cooldown = 0.0f;
-
-        if (keystate[SDL_SCANCODE_SPACE] && !space_pressed && shoot_cooldown <= 0.0f && turret_mounted) {
-            space_pressed = true;
-    
-            // Get turret world position and angle
-            float turret_x, turret_y, turret_angle;
-            mount_get_world_position(tank, "main_weapon", &turret_x, &turret_y, &turret_angle);
-    
-            // Calculate bullet spawn position (slightly in front of turret)
-            float spawn_distance = 30.0f; // Distance in front of turret
-            float angle_rad = turret_angle * (M_PI / 180.0f);
-            float bullet_x = turret_x + cosf(angle_rad) * spawn_distance;
-            float bullet_y = turret_y + sinf(angle_rad) * spawn_distance;
-    
-            // Spawn bullet
-            spawn_bullet(renderer, bullet_x, bullet_y, turret_angle, 400.0f);
-    
-            shoot_cooldown = SHOOT_COOLDOWN_TIME;
-        }
+        Uint8 input = player_input_from_keyboard(keystate);
 
-        if (!keystate[SDL_SCANCODE_SPACE]) {
-            space_pressed = false;
-        }
+        if (connect_to) {
+            // The server simulates; we send input and show what comes back
+            net_client_update(renderer, input);
+            Entity* own = net_client_own_tank();
+            if (own) camera_follow(&camera, own, 8.0f, FIXED_DT);
+        } else {
+            sim_state_save();
+            recorded_inputs[sim.tick % SIM_ROLLBACK_FRAMES] = input;
+            if (record) fputc(input, record);
+            float impact = simulate_tick(&player, renderer, input);
+            if (rollback_depth)
+                rollback_check(&player, renderer, recorded_inputs, rollback_depth);
 
-        // ---- Physics ----
-        if (turret_remount_cooldown > 0.0f) {
-            turret_remount_cooldown -= FIXED_DT;
-            if (turret_remount_cooldown < 0.0f)
-                turret_remount_cooldown = 0.0f;
-        }
+            // Effects only on the live tick, never on a resimulated one
+            if (sparks && impact > 20.0f)
+                particle_emitter_burst(sparks, tank->x, tank->y, tank->angle, 40);
+            camera_follow(&camera, tank, 8.0f, FIXED_DT);
 
-        if (check_entities_collision(tank, rock)) {
-	    float change = tank->speed / 10;
-	    int limit   = (int)change;
-            tank->speed = -tank->speed * 0.2;
-	    tank->angle = tank->angle + (rand() % (limit + 1 - -limit) - -limit);
+            // Re-integrates only when the player changes cell, a slice per frame
+            if (ai_fields.count) nav_field_set_goal(ai_fields.items[0], tank->x, tank->y);
+            nav_update(NAV_DEFAULT_BUDGET);
         }
-	
-	entity_update(tank, keystate, FIXED_DT);
-	mount_update_all(tank, FIXED_DT);
-	update_all_bullets(FIXED_DT);
-	
-        // ---- Rendering ----
-        SDL_SetRenderDrawColor(renderer, 10, 10, 10, 255);
-	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        SDL_RenderClear(renderer);
+        if (connect_to) world_chunks_update(&camera);
+	particles_update_all(FIXED_DT);
 
-	entity_render(renderer, tank, tank->width, tank->height);
-	entity_render(renderer, rock, rock->width, rock->height);
-	mount_render_all(renderer, tank);
-	render_all_bullets(renderer);
+	// One animation tick per frame from the real frame delta
+	animation_tick(delta_ms);
 	
-	if (flame->base.active)
-            render_animated_entity(renderer, flame, delta_ms);
-	if (left_burner->base.active)
-	    render_animated_entity(renderer, left_burner, delta_ms);
-	if (right_burner->base.active)
-	    render_animated_entity(renderer, right_burner, delta_ms);
-
-	// Debug polygon lines
-	SDL_SetRenderDrawColor(renderer, 10, 10, 10, 255);
-	draw_all_collision_polygons(renderer, all_entities, entity_count);
-
-        SDL_RenderPresent(renderer);
-        SDL_Delay(16);
+        // ---- Rendering ----
+        SceneRefs scene = { tank, all_entities, entity_count, NULL, 0 };
+        scene.scenery = world_chunks_gather(&scene.scenery_count);
+        if (dirty_rects_enabled()) {
+            dirty_rects_render_frame(renderer, draw_scene, &scene);
+        } else {
+            SDL_SetRenderDrawColor(renderer, BACKGROUND.r, BACKGROUND.g, BACKGROUND.b, BACKGROUND.a);
+            SDL_RenderClear(renderer);
+            draw_scene(renderer, &scene);
+            SDL_RenderPresent(renderer);
+        }
+        frame_pacing_after_present();
     }
 
     // ---- Cleanup ----
-    mount_system_cleanup(tank);
+    if (record) fclose(record);
+    hot_reload_shutdown();
+    if (connect_to) net_client_shutdown();
+    player_tank_destroy(&player);
     cleanup_bullet_system();
-    shutdown_game(window, renderer, entities, entity_count);
+    world_chunks_shutdown();
+    nav_shutdown();
+    cleanup_ai_tanks();
+    spatial_shutdown();
+    particles_shutdown();
+    dirty_rects_shutdown();
+    if (particle_texture) SDL_DestroyTexture(particle_texture);
+    shutdown_game(window, renderer, NULL, 0);
     return 0;
 }
@@ -1,4 +1,5 @@
 #include "mount_helpers.h"
+#include "sim_state.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -9,10 +10,10 @@ bool register_mount_and_attach(Entity* parent, const char* mount_name, int slot_
                                Entity* child) {
     if (!parent || !child) return false;
 
-    MountOffset* offsets = mount_create_offset_table(1);
-    mount_set_offset(offsets, 0, offset_angle, offset_x, offset_y);
+    MountOffset offset;
+    mount_set_offset(&offset, 0, offset_angle, offset_x, offset_y);
 
-    int assigned_slot = mount_add_point(parent, mount_name, offsets, 1, rotate_with_parent, default_rotation, slot_index);
+    int assigned_slot = mount_add_point(parent, mount_name, &offset, 1, rotate_with_parent, default_rotation, slot_index);
     if (assigned_slot == -1) {
         SDL_Log("Failed to add mount point: %s", mount_name);
         return false;
@@ -21,7 +22,7 @@ bool register_mount_and_attach(Entity* parent, const char* mount_name, int slot_
     float world_x, world_y, world_angle;
     mount_get_world_position(parent, mount_name, &world_x, &world_y, &world_angle);
     entity_set_position(child, world_x, world_y);
-    child->angle = world_angle;
+    entity_set_angle(child, world_angle);
 
     bool ok = mount_attach(parent, mount_name, child);
     if (!ok) {
@@ -42,12 +43,8 @@ bool register_mount_and_attach_animated(Entity* parent, const char* mount_name,
 }
 
 Entity* get_mounted_entity(Entity* parent, const char* mount_name) {
-    for (int i = 0; i < parent->entity_mount_count; i++) {
-        if (parent->mount_points[i].name && strcmp(parent->mount_points[i].name, mount_name) == 0) {
-            return parent->mounted_entities[i];
-        }
-    }
-    return NULL;
+    MountPoint* mp = mount_get(parent, mount_name);
+    return mp ? sim_entity(mp->child) : NULL;
 }
 
 void detach_mounted_entity(Entity* parent, const char* mount_name) {
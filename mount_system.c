@@ -4,6 +4,7 @@
 #include "mount_system.h"
 #include "entity.h"
 #include "entity_render_helpers.h"
+#include "sim_state.h"
 #include <SDL_log.h>
 
 MountOffset* mount_create_offset_table(int count) {
@@ -16,60 +17,96 @@ void mount_set_offset(MountOffset* offsets, int index, float angle, float offset
     offsets[index].offset_y = offset_y;
 }
 
-void mount_system_init(Entity* entity, int mount_count) {
-    entity->mount_points = calloc(mount_count, sizeof(MountPoint));
-    entity->mounted_entities = calloc(mount_count, sizeof(Entity*));  // <-- this line was missing
-    entity->entity_mount_count = mount_count;
+// An entity's mount points are a contiguous run of sim.mounts
+static MountPoint* mount_points(const Entity* entity, int* count) {
+    const EntityLinks* links = sim_links(entity);
+    *count = links->mount_count;
+    return links->mount_first >= 0 ? &sim.mounts[links->mount_first] : NULL;
 }
 
-void mount_system_cleanup(Entity* entity) {    
-    // Cleanup entity mounts (new)
-    if (entity->mount_points) {
-        for (int i = 0; i < entity->entity_mount_count; i++) {
-            if (entity->mount_points[i].name) {
-                free(entity->mount_points[i].name);
-            }
-            if (entity->mount_points[i].offsets) {
-                free(entity->mount_points[i].offsets);
-            }
+static MountPoint* find_mount(const Entity* entity, const char* mount_name) {
+    int count;
+    MountPoint* points = mount_points(entity, &count);
+    for (int i = 0; i < count; i++) {
+        if (points[i].name[0] && strcmp(points[i].name, mount_name) == 0)
+            return &points[i];
+    }
+    return NULL;
+}
+
+void mount_system_init(Entity* entity, int mount_count) {
+    mount_system_cleanup(entity);
+
+    // First fit; mount tables are reserved at spawn and rarely freed
+    int run = 0;
+    for (int i = 0; i < MAX_MOUNT_POINTS; i++) {
+        run = sim.mounts[i].used ? 0 : run + 1;
+        if (run < mount_count) continue;
+
+        int first = i - mount_count + 1;
+        for (int j = first; j <= i; j++) {
+            memset(&sim.mounts[j], 0, sizeof(MountPoint));
+            sim.mounts[j].used = true;
+            sim.mounts[j].child = -1;
         }
-        free(entity->mount_points);
-        free(entity->mounted_entities);
-        entity->mount_points = NULL;
-        entity->mounted_entities = NULL;
-        entity->entity_mount_count = 0;
+        EntityLinks* links = sim_links(entity);
+        links->mount_first = (Sint16)first;
+        links->mount_count = (Sint16)mount_count;
+        return;
     }
+    SDL_Log("Mount table full (%d points)", MAX_MOUNT_POINTS);
 }
 
-int mount_add_point(Entity* entity, const char* name, MountOffset* offsets, int offset_count,
+void mount_system_cleanup(Entity* entity) {
+    int count;
+    MountPoint* points = mount_points(entity, &count);
+    for (int i = 0; i < count; i++) {
+        if (points[i].child >= 0)
+            sim_link(points[i].child)->mount_parent = -1;
+        points[i].used = false;
+    }
+    EntityLinks* links = sim_links(entity);
+    links->mount_first = -1;
+    links->mount_count = 0;
+}
+
+int mount_add_point(Entity* entity, const char* name, const MountOffset* offsets, int offset_count,
                     bool inherit_rotation, float rotation_offset, int slot_index) {
-    if (!entity || !entity->mount_points || !entity->mounted_entities) return -1;
+    if (!entity) return -1;
+    int count;
+    MountPoint* points = mount_points(entity, &count);
+    if (!points) return -1;
 
     // If -1, find a free slot
     if (slot_index == -1) {
-        for (int i = 0; i < entity->entity_mount_count; i++) {
-            if (!entity->mount_points[i].name) {
+        for (int i = 0; i < count; i++) {
+            if (!points[i].name[0]) {
                 slot_index = i;
                 break;
             }
         }
     }
 
-    if (slot_index < 0 || slot_index >= entity->entity_mount_count) {
+    if (slot_index < 0 || slot_index >= count) {
         SDL_Log("FATAL: Invalid or no available mount slot!");
         return -1;
     }
 
-    if (entity->mount_points[slot_index].name) {
+    MountPoint* mp = &points[slot_index];
+    if (mp->name[0]) {
         SDL_Log("FATAL: Slot %d already occupied!", slot_index);
         return -1;
     }
+    if (offset_count > MAX_MOUNT_OFFSETS) {
+        SDL_Log("Mount %s: %d offsets, keeping %d", name, offset_count, MAX_MOUNT_OFFSETS);
+        offset_count = MAX_MOUNT_OFFSETS;
+    }
 
-    entity->mount_points[slot_index].name = strdup(name);
-    entity->mount_points[slot_index].offsets = offsets;
-    entity->mount_points[slot_index].offset_count = offset_count;
-    entity->mount_points[slot_index].inherit_rotation = inherit_rotation;
-    entity->mount_points[slot_index].rotation_offset = rotation_offset;
+    SDL_strlcpy(mp->name, name, sizeof(mp->name));
+    memcpy(mp->offsets, offsets, sizeof(MountOffset) * offset_count);
+    mp->offset_count = offset_count;
+    mp->inherit_rotation = inherit_rotation;
+    mp->rotation_offset = rotation_offset;
 
     return slot_index;
 }
@@ -104,13 +141,7 @@ void interpolate_mount_offset(MountPoint* mount, float angle, float* out_x, floa
 void mount_get_world_position(const Entity* entity, const char* mount_name, 
                                    float* out_x, float* out_y, float* out_angle) {
     // Find entity mount point
-    MountPoint* mount = NULL;
-    for (int i = 0; i < entity->entity_mount_count; i++) {
-        if (entity->mount_points[i].name && strcmp(entity->mount_points[i].name, mount_name) == 0) {
-            mount = &entity->mount_points[i];
-            break;
-        }
-    }
+    const MountPoint* mount = find_mount(entity, mount_name);
     
     if (!mount) {
         *out_x = entity->x;
@@ -144,9 +175,8 @@ void mount_get_world_position(const Entity* entity, const char* mount_name,
     }
     
     // Transform to world coordinates
-    float angle_rad = entity->angle * (M_PI / 180.0f);
-    float cos_a = cosf(angle_rad);
-    float sin_a = sinf(angle_rad);
+    float cos_a, sin_a;
+    entity_heading(entity, &cos_a, &sin_a);
     
     *out_x = entity->x + (offset_x * cos_a - offset_y * sin_a);
     *out_y = entity->y + (offset_x * sin_a + offset_y * cos_a);
@@ -167,44 +197,41 @@ void mount_get_world_position(const Entity* entity, const char* mount_name,
 }
 
 bool mount_attach(Entity* parent, const char* mount_name, Entity* child) {
-    int mount_index = -1;
-    for (int i = 0; i < parent->entity_mount_count; i++) {
-        if (parent->mount_points[i].name && strcmp(parent->mount_points[i].name, mount_name) == 0) {
-            mount_index = i;
-            break;
-        }
-    }
-    if (mount_index == -1) return false;
+    MountPoint* mp = find_mount(parent, mount_name);
+    if (!mp) return false;
     
     // For now, only support one entity per mount point (can be extended later)
-    if (parent->mounted_entities[mount_index] != NULL) {
+    if (mp->child >= 0) {
         return false; // Already occupied
     }
     
-    parent->mounted_entities[mount_index] = child;
+    mp->child = child->slot;
+    sim_links(child)->mount_parent = parent->slot;
     return true;
 }
 
 bool mount_detach(Entity* parent, const char* mount_name) {
-    for (int i = 0; i < parent->entity_mount_count; i++) {
-        if (parent->mount_points[i].name && strcmp(parent->mount_points[i].name, mount_name) == 0) {
-            parent->mounted_entities[i] = NULL;
-            return true;
-        }
-    }
-    return false;
+    MountPoint* mp = find_mount(parent, mount_name);
+    if (!mp) return false;
+    if (mp->child >= 0)
+        sim_link(mp->child)->mount_parent = -1;
+    mp->child = -1;
+    return true;
 }
 
 void mount_update_all(Entity* entity, float dt) {
-    for (int i = 0; i < entity->entity_mount_count; i++) {
-        Entity* mounted = entity->mounted_entities[i];
+    int count;
+    MountPoint* points = mount_points(entity, &count);
+    for (int i = 0; i < count; i++) {
+        Entity* mounted = sim_entity(points[i].child);
         if (mounted && mounted->active) {
             // Update mounted entity position
             float x, y, angle;
-            mount_get_world_position(entity, entity->mount_points[i].name, &x, &y, &angle);
+            mount_get_world_position(entity, points[i].name, &x, &y, &angle);
             mounted->x = x;
             mounted->y = y;
-            mounted->angle = angle;
+            if (mounted->angle != angle)
+                entity_set_angle(mounted, angle);
             
             // Update the entity itself
             entity_update(mounted, NULL, dt);
@@ -216,16 +243,13 @@ void mount_update_all(Entity* entity, float dt) {
 }
 
 void mount_render_all(SDL_Renderer* renderer, const Entity* entity) {
-    for (int i = 0; i < entity->entity_mount_count; i++) {
-        Entity* mounted = entity->mounted_entities[i];
+    int count;
+    const MountPoint* points = mount_points(entity, &count);
+    for (int i = 0; i < count; i++) {
+        const Entity* mounted = sim_entity(points[i].child);
         if (mounted && mounted->active) {
-            if (mounted->type == ENTITY_ANIMATED) {
-                AnimatedEntity* anim_entity = (AnimatedEntity*)mounted;
-                static Uint32 last_time = 0;
-                Uint32 now = SDL_GetTicks();
-                float delta = (last_time == 0) ? 16.0f : (now - last_time);
-                last_time = now;
-                render_animated_entity(renderer, anim_entity, delta);  // Pass AnimatedEntity directly
+            if (entity_cold(mounted)->type == ENTITY_ANIMATED) {
+                render_animated_entity(renderer, (const AnimatedEntity*)mounted);
             } else {
                 entity_render(renderer, mounted, mounted->width, mounted->height);
             }
@@ -237,10 +261,5 @@ void mount_render_all(SDL_Renderer* renderer, const Entity* entity) {
 
 // Returns a pointer to the MountPoint with the given name, or NULL if not found
 MountPoint* mount_get(Entity* parent, const char* name) {
-    for (int i = 0; i < parent->entity_mount_count; i++) {
-        if (strcmp(parent->mount_points[i].name, name) == 0) {
-            return &parent->mount_points[i];
-        }
-    }
-    return NULL;
+    return find_mount(parent, name);
 }
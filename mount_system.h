@@ -13,14 +13,22 @@ typedef struct {
     float offset_y;
 } MountOffset;
 
+#define MOUNT_NAME_MAX 24
+#define MAX_MOUNT_OFFSETS 4
+#define MAX_MOUNT_POINTS 256        // shared by every entity, lives in SimState
+
+// Stored inline so the whole mount table is plain data in SimState
 typedef struct MountPoint {
-    char* name;
-    MountOffset* offsets;
+    char name[MOUNT_NAME_MAX];      // empty: reserved but not yet added
+    MountOffset offsets[MAX_MOUNT_OFFSETS];
     int offset_count;
     bool inherit_rotation;
     float rotation_offset;
+    bool used;                      // reserved by mount_system_init
+    Sint16 child;                   // mounted entity slot, -1 = empty
 } MountPoint;
 
+// Scratch table for mount_add_point, which copies it; caller frees
 MountOffset* mount_create_offset_table(int count);
 void mount_set_offset(MountOffset* offsets, int index, float angle, float offset_x, float offset_y);
 
@@ -29,7 +37,7 @@ void mount_update_all(Entity* entity, float dt);
 void mount_render_all(SDL_Renderer* renderer, const Entity* entity);
 void mount_system_cleanup(Entity* entity);
 void interpolate_mount_offset(MountPoint* mount, float angle, float* out_x, float* out_y);
-int  mount_add_point(Entity* entity, const char* name, MountOffset* offsets, int offset_count,
+int  mount_add_point(Entity* entity, const char* name, const MountOffset* offsets, int offset_count,
 		     bool inherit_rotation, float rotation_offset, int slot_index);
 
 void mount_get_world_position(const Entity* entity, const char* mount_name, 
@@ -0,0 +1,437 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "navigation.h"
+#include "collision.h"
+#include "camera.h"
+#include "spatial_query.h"
+
+#define NAV_BUCKETS 64              // power of two above the largest step cost (14 * NAV_COST_NEAR)
+#define NAV_UNREACHED 0xFFFFFFFFu
+#define NAV_NOT_QUEUED -2
+#define NAV_FLOW_GOAL 254
+#define NAV_FLOW_NONE 255
+
+typedef struct {
+    bool used;
+    bool dirty;                 // needs an integration pass
+    bool ready;                 // flow holds a complete field
+    float goal_x, goal_y;
+    int goal_cell;
+    Uint8* flow;                // direction index per cell, or NAV_FLOW_*
+} NavField;
+
+static Uint8* cost = NULL;
+static int grid_w = 0, grid_h = 0;
+static float cell = NAV_CELL_SIZE;
+static float origin_x = 0, origin_y = 0;
+
+static NavField fields[NAV_MAX_FIELDS];
+
+// One integration at a time shares these; a field only keeps its flow.
+// Dial's algorithm: step costs are small integers, so a ring of buckets
+// replaces the priority queue and each cell is settled in O(1).
+static Uint32* dist = NULL;
+static int* next_in_bucket = NULL;
+static int* prev_in_bucket = NULL;
+static int buckets[NAV_BUCKETS];
+static Uint32 current_dist = 0;
+static int queued = 0;
+static int working = -1;        // field being integrated, -1 = idle
+
+// Clockwise from +x, matching entity angles (y points down)
+static const int dir_dx[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int dir_dy[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const float dir_angle[8] = { 0, 45, 90, 135, 180, -135, -90, -45 };
+static const float dir_unit[8][2] = {
+    { 1, 0 }, { 0.70710678f, 0.70710678f }, { 0, 1 }, { -0.70710678f, 0.70710678f },
+    { -1, 0 }, { -0.70710678f, -0.70710678f }, { 0, -1 }, { 0.70710678f, -0.70710678f },
+};
+
+bool nav_init(float cell_size) {
+    nav_shutdown();
+
+    WorldBounds wb = world_get_bounds();
+    cell = cell_size > 0 ? cell_size : NAV_CELL_SIZE;
+    origin_x = wb.min_x;
+    origin_y = wb.min_y;
+    grid_w = (int)ceilf((wb.max_x - wb.min_x) / cell);
+    grid_h = (int)ceilf((wb.max_y - wb.min_y) / cell);
+    if (grid_w < 1) grid_w = 1;
+    if (grid_h < 1) grid_h = 1;
+
+    int cells = grid_w * grid_h;
+    cost = malloc(cells);
+    dist = malloc(sizeof(Uint32) * cells);
+    next_in_bucket = malloc(sizeof(int) * cells);
+    prev_in_bucket = malloc(sizeof(int) * cells);
+    if (!cost || !dist || !next_in_bucket || !prev_in_bucket) {
+        SDL_Log("Navigation grid %dx%d: out of memory", grid_w, grid_h);
+        nav_shutdown();
+        return false;
+    }
+    memset(cost, NAV_COST_OPEN, cells);
+    return true;
+}
+
+void nav_shutdown(void) {
+    for (int i = 0; i < NAV_MAX_FIELDS; i++) nav_field_destroy(i);
+    free(cost);
+    free(dist);
+    free(next_in_bucket);
+    free(prev_in_bucket);
+    cost = NULL;
+    dist = NULL;
+    next_in_bucket = prev_in_bucket = NULL;
+    grid_w = grid_h = 0;
+    working = -1;
+}
+
+static int cell_at(float x, float y) {
+    int cx = (int)floorf((x - origin_x) / cell);
+    int cy = (int)floorf((y - origin_y) / cell);
+    if (cx < 0) cx = 0;
+    if (cy < 0) cy = 0;
+    if (cx >= grid_w) cx = grid_w - 1;
+    if (cy >= grid_h) cy = grid_h - 1;
+    return cy * grid_w + cx;
+}
+
+// ---- Rasterization ----
+
+static void mark_fields_dirty(void) {
+    for (int i = 0; i < NAV_MAX_FIELDS; i++) {
+        if (fields[i].used) fields[i].dirty = true;
+    }
+    working = -1;   // restart with the new costs
+}
+
+void nav_add_obstacle(Entity* e) {
+    if (!cost || !e) return;
+
+    // World-space outline: the collider, or the sprite box without one
+    SDL_Point stack[COLLISION_STACK_POINTS];
+    SDL_Point* poly = stack;
+    int n = 4;
+    ColliderComponent* c = get_collider(e);
+    if (c && c->type == COLLIDER_POLYGON && c->polygon.point_count >= 3) {
+        n = c->polygon.point_count;
+        if (n > COLLISION_STACK_POINTS) poly = malloc(sizeof(SDL_Point) * n);
+        if (!poly) return;
+        transform_polygon(c->polygon.points, poly, n, e);
+    } else if (c && c->type == COLLIDER_CIRCLE) {
+        // Its bounding square; obstacles only need to be conservative
+        float cx, cy, r = c->circle.radius;
+        collider_circle_center(c, e, &cx, &cy);
+        poly[0] = (SDL_Point){ (int)(cx - r), (int)(cy - r) };
+        poly[1] = (SDL_Point){ (int)(cx + r), (int)(cy - r) };
+        poly[2] = (SDL_Point){ (int)(cx + r), (int)(cy + r) };
+        poly[3] = (SDL_Point){ (int)(cx - r), (int)(cy + r) };
+    } else {
+        const SDL_Point box[4] = { { 0, 0 }, { e->width, 0 }, { e->width, e->height }, { 0, e->height } };
+        transform_polygon(box, poly, n, e);
+    }
+
+    nav_add_outline(poly, n);
+    if (poly != stack) free(poly);
+}
+
+void nav_add_outline(const SDL_Point* poly, int n) {
+    if (!cost || !poly || n <= 0) return;
+
+    float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+    for (int i = 0; i < n; i++) {
+        min_x = fminf(min_x, poly[i].x);
+        min_y = fminf(min_y, poly[i].y);
+        max_x = fmaxf(max_x, poly[i].x);
+        max_y = fmaxf(max_y, poly[i].y);
+    }
+
+    // Cells whose centers come within the agent radius are blocked; one more
+    // cell out is expensive, so paths keep some clearance where they can
+    float reach = NAV_AGENT_RADIUS + cell;
+    int x0 = (int)floorf((min_x - reach - origin_x) / cell);
+    int y0 = (int)floorf((min_y - reach - origin_y) / cell);
+    int x1 = (int)floorf((max_x + reach - origin_x) / cell);
+    int y1 = (int)floorf((max_y + reach - origin_y) / cell);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= grid_w) x1 = grid_w - 1;
+    if (y1 >= grid_h) y1 = grid_h - 1;
+
+    bool changed = false;
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            float px = origin_x + (cx + 0.5f) * cell;
+            float py = origin_y + (cy + 0.5f) * cell;
+            float d = polygon_point_distance(poly, n, px, py);
+            Uint8 value = d <= NAV_AGENT_RADIUS ? NAV_COST_BLOCKED : d <= reach ? NAV_COST_NEAR : 0;
+
+            // Costs only rise, so rasterizing a rock twice changes nothing
+            Uint8* cur = &cost[cy * grid_w + cx];
+            if (value > *cur) {
+                *cur = value;
+                changed = true;
+            }
+        }
+    }
+    if (changed) mark_fields_dirty();
+}
+
+bool nav_area_open(float x, float y, float radius) {
+    if (!cost) return true;
+    if (x - radius < origin_x || y - radius < origin_y ||
+        x + radius > origin_x + grid_w * cell || y + radius > origin_y + grid_h * cell)
+        return false;   // past the world edge
+
+    int x0 = (int)floorf((x - radius - origin_x) / cell);
+    int y0 = (int)floorf((y - radius - origin_y) / cell);
+    int x1 = (int)floorf((x + radius - origin_x) / cell);
+    int y1 = (int)floorf((y + radius - origin_y) / cell);
+    if (x1 >= grid_w) x1 = grid_w - 1;
+    if (y1 >= grid_h) y1 = grid_h - 1;
+
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            float dx = origin_x + (cx + 0.5f) * cell - x;
+            float dy = origin_y + (cy + 0.5f) * cell - y;
+            if (dx * dx + dy * dy <= radius * radius && cost[cy * grid_w + cx] == NAV_COST_BLOCKED)
+                return false;
+        }
+    }
+    return true;
+}
+
+// ---- Fields ----
+
+int nav_field_create(float goal_x, float goal_y) {
+    if (!cost) return -1;
+    for (int i = 0; i < NAV_MAX_FIELDS; i++) {
+        NavField* f = &fields[i];
+        if (f->used) continue;
+
+        f->flow = malloc(grid_w * grid_h);
+        if (!f->flow) return -1;
+        f->used = true;
+        f->ready = false;
+        f->dirty = true;
+        f->goal_x = goal_x;
+        f->goal_y = goal_y;
+        f->goal_cell = cell_at(goal_x, goal_y);
+        return i;
+    }
+    SDL_Log("Navigation: all %d flow fields in use", NAV_MAX_FIELDS);
+    return -1;
+}
+
+void nav_field_destroy(int field) {
+    if (field < 0 || field >= NAV_MAX_FIELDS || !fields[field].used) return;
+    free(fields[field].flow);
+    memset(&fields[field], 0, sizeof(NavField));
+    if (working == field) working = -1;
+}
+
+void nav_field_set_goal(int field, float goal_x, float goal_y) {
+    if (field < 0 || field >= NAV_MAX_FIELDS || !fields[field].used) return;
+    NavField* f = &fields[field];
+    f->goal_x = goal_x;
+    f->goal_y = goal_y;
+
+    int goal_cell = cell_at(goal_x, goal_y);
+    if (goal_cell == f->goal_cell) return;
+    f->goal_cell = goal_cell;
+    f->dirty = true;
+    if (working == field) working = -1;
+}
+
+bool nav_field_ready(int field) {
+    return field >= 0 && field < NAV_MAX_FIELDS && fields[field].used && fields[field].ready;
+}
+
+// ---- Integration ----
+
+static void bucket_push(int c, Uint32 d) {
+    int b = d & (NAV_BUCKETS - 1);
+    dist[c] = d;
+    prev_in_bucket[c] = -1;
+    next_in_bucket[c] = buckets[b];
+    if (buckets[b] >= 0) prev_in_bucket[buckets[b]] = c;
+    buckets[b] = c;
+    queued++;
+}
+
+static void bucket_unlink(int c) {
+    int b = dist[c] & (NAV_BUCKETS - 1);
+    if (prev_in_bucket[c] >= 0) next_in_bucket[prev_in_bucket[c]] = next_in_bucket[c];
+    else buckets[b] = next_in_bucket[c];
+    if (next_in_bucket[c] >= 0) prev_in_bucket[next_in_bucket[c]] = prev_in_bucket[c];
+    prev_in_bucket[c] = NAV_NOT_QUEUED;
+    queued--;
+}
+
+static void integration_start(NavField* f) {
+    int cells = grid_w * grid_h;
+    for (int i = 0; i < cells; i++) {
+        dist[i] = NAV_UNREACHED;
+        prev_in_bucket[i] = NAV_NOT_QUEUED;
+    }
+    for (int b = 0; b < NAV_BUCKETS; b++) buckets[b] = -1;
+    current_dist = 0;
+    queued = 0;
+    bucket_push(f->goal_cell, 0);
+}
+
+// A diagonal step may not cut the corner of a blocked cell
+static bool step_allowed(int cx, int cy, int d) {
+    int nx = cx + dir_dx[d], ny = cy + dir_dy[d];
+    if (nx < 0 || ny < 0 || nx >= grid_w || ny >= grid_h) return false;
+    if (cost[ny * grid_w + nx] == NAV_COST_BLOCKED) return false;
+    if (dir_dx[d] && dir_dy[d]) {
+        if (cost[cy * grid_w + nx] == NAV_COST_BLOCKED) return false;
+        if (cost[ny * grid_w + cx] == NAV_COST_BLOCKED) return false;
+    }
+    return true;
+}
+
+// Settle up to budget cells; returns what is left of the budget
+static int integration_step(int budget) {
+    while (budget > 0 && queued > 0) {
+        while (buckets[current_dist & (NAV_BUCKETS - 1)] < 0) current_dist++;
+        int c = buckets[current_dist & (NAV_BUCKETS - 1)];
+        bucket_unlink(c);
+        budget--;
+
+        int cx = c % grid_w, cy = c / grid_w;
+        for (int d = 0; d < 8; d++) {
+            if (!step_allowed(cx, cy, d)) continue;
+            int n = c + dir_dy[d] * grid_w + dir_dx[d];
+            Uint32 step = (dir_dx[d] && dir_dy[d]) ? 14 : 10;
+            Uint32 nd = dist[c] + step * cost[n];
+            if (nd >= dist[n]) continue;
+            if (prev_in_bucket[n] != NAV_NOT_QUEUED) bucket_unlink(n);
+            bucket_push(n, nd);
+        }
+    }
+    return budget;
+}
+
+// Each cell points at its cheapest neighbor
+static void integration_finish(NavField* f) {
+    for (int cy = 0; cy < grid_h; cy++) {
+        for (int cx = 0; cx < grid_w; cx++) {
+            int c = cy * grid_w + cx;
+            if (dist[c] == 0) {
+                f->flow[c] = NAV_FLOW_GOAL;
+                continue;
+            }
+
+            Uint8 best = NAV_FLOW_NONE;
+            Uint32 best_dist = dist[c];
+            for (int d = 0; d < 8; d++) {
+                if (!step_allowed(cx, cy, d)) continue;
+                Uint32 nd = dist[c + dir_dy[d] * grid_w + dir_dx[d]];
+                if (nd < best_dist) {
+                    best_dist = nd;
+                    best = (Uint8)d;
+                }
+            }
+            f->flow[c] = best;
+        }
+    }
+    f->ready = true;
+}
+
+void nav_update(int budget) {
+    if (!cost) return;
+
+    while (budget > 0) {
+        if (working < 0) {
+            for (int i = 0; i < NAV_MAX_FIELDS && working < 0; i++) {
+                if (fields[i].used && fields[i].dirty) working = i;
+            }
+            if (working < 0) return;    // nothing to do
+            fields[working].dirty = false;
+            integration_start(&fields[working]);
+        }
+
+        budget = integration_step(budget);
+        if (queued == 0) {
+            integration_finish(&fields[working]);
+            working = -1;
+        }
+    }
+}
+
+// ---- Agents ----
+
+// Heading of the field at (x, y); false on the goal cell itself
+static bool sample_angle(const NavField* f, float x, float y, float* angle) {
+    int c = cell_at(x, y);
+    Uint8 d = f->ready ? f->flow[c] : NAV_FLOW_NONE;
+    if (d == NAV_FLOW_GOAL || (d == NAV_FLOW_NONE && c == f->goal_cell)) return false;
+    if (d < 8) {
+        *angle = dir_angle[d];
+    } else {
+        *angle = atan2f(f->goal_y - y, f->goal_x - x) * (180.0f / 3.14159265f);
+    }
+    return true;
+}
+
+bool nav_sample(int field, float x, float y, float* dir_x, float* dir_y) {
+    if (field < 0 || field >= NAV_MAX_FIELDS || !fields[field].used) return false;
+    const NavField* f = &fields[field];
+
+    int c = cell_at(x, y);
+    Uint8 d = f->ready ? f->flow[c] : NAV_FLOW_NONE;
+    if (d < 8) {
+        *dir_x = dir_unit[d][0];
+        *dir_y = dir_unit[d][1];
+        return true;
+    }
+
+    float dx = f->goal_x - x, dy = f->goal_y - y;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len < 1e-3f) return false;
+    *dir_x = dx / len;
+    *dir_y = dy / len;
+    return true;
+}
+
+// Two rays a hull's half-width either side of the line to the goal; when
+// neither meets scenery the agent can drive straight at it instead of along
+// the grid's eight directions
+static bool goal_in_sight(const Entity* e, const NavField* f) {
+    float dx = f->goal_x - e->x, dy = f->goal_y - e->y;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len < 1e-3f) return true;
+    float ox = -dy / len * NAV_AGENT_RADIUS, oy = dx / len * NAV_AGENT_RADIUS;
+    SpatialRay rays[2] = {
+        { e->x + ox, e->y + oy, f->goal_x + ox, f->goal_y + oy, COLLISION_LAYER_SCENERY, e },
+        { e->x - ox, e->y - oy, f->goal_x - ox, f->goal_y - oy, COLLISION_LAYER_SCENERY, e },
+    };
+    SpatialHit hits[2];
+    return spatial_raycast_batch(rays, 2, hits) == 0;
+}
+
+void nav_steer_agents(Entity** agents, const int* field_of, int count, float dt) {
+    float max_turn = NAV_TURN_RATE * dt;
+    for (int i = 0; i < count; i++) {
+        Entity* e = agents[i];
+        int fi = field_of[i];
+        if (!e || !e->active || fi < 0 || fi >= NAV_MAX_FIELDS || !fields[fi].used) continue;
+
+        float target;
+        if (!sample_angle(&fields[fi], e->x, e->y, &target)) continue;  // arrived
+        if (goal_in_sight(e, &fields[fi]))
+            target = atan2f(fields[fi].goal_y - e->y, fields[fi].goal_x - e->x) * (180.0f / 3.14159265f);
+
+        float diff = target - e->angle;
+        while (diff > 180.0f) diff -= 360.0f;
+        while (diff < -180.0f) diff += 360.0f;
+
+        float turn = fmaxf(-max_turn, fminf(max_turn, diff));
+        if (turn != 0.0f) entity_turn(e, turn);
+        if (fabsf(diff) < NAV_THRUST_CONE) entity_thrust(e, e->accel * dt);
+    }
+}
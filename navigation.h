@@ -0,0 +1,56 @@
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+#define NAV_CELL_SIZE 25.0f          // world units per grid cell
+#define NAV_AGENT_RADIUS 30.0f       // obstacles are inflated by this much
+#define NAV_MAX_FIELDS 8             // goals with a live flow field
+#define NAV_DEFAULT_BUDGET 4096      // cells integrated per nav_update
+#define NAV_TURN_RATE 180.0f         // degrees per second when steering
+#define NAV_THRUST_CONE 45.0f        // only thrust when this close to the flow
+
+#define NAV_COST_OPEN 1
+#define NAV_COST_NEAR 3              // within one cell of an inflated obstacle
+#define NAV_COST_BLOCKED 255
+
+// Cost grid over the world bounds plus one flow field per goal. A field
+// is one integration pass over the grid, independent of how many agents
+// follow it. Static scenery only, and not part of SimState: rocks never
+// move, so a rasterized rock stays in the grid after its chunk unloads.
+bool nav_init(float cell_size);
+void nav_shutdown(void);
+
+// Rasterize a static collider into the cost grid. Fields whose paths may
+// change are queued for another integration pass.
+void nav_add_obstacle(Entity* e);
+// Same for a world-space outline, for scenery that is not spawned
+void nav_add_outline(const SDL_Point* poly, int n);
+
+// No blocked cell within radius of the point, and the circle inside the
+// grid: somewhere an agent of that size can be placed
+bool nav_area_open(float x, float y, float radius);
+
+// Flow toward a goal point. Returns a field handle or -1.
+int  nav_field_create(float goal_x, float goal_y);
+void nav_field_destroy(int field);
+// Re-integrates only when the goal moves to another cell
+void nav_field_set_goal(int field, float goal_x, float goal_y);
+bool nav_field_ready(int field);
+
+// Advance pending integrations by at most `budget` cells. Agents keep
+// following the previous field until the new one is complete.
+void nav_update(int budget);
+
+// Unit direction of the field at a world position; toward the goal itself
+// where the grid has no answer (blocked cell, unreachable, not ready yet)
+bool nav_sample(int field, float x, float y, float* dir_x, float* dir_y);
+
+// Steer agents[i] along fields[i] with entity_turn/entity_thrust, or straight
+// at the goal when no scenery is in the way (spatial_raycast: the grid must
+// have been rebuilt this tick)
+void nav_steer_agents(Entity** agents, const int* fields, int count, float dt);
+
+#endif
@@ -0,0 +1,205 @@
+#include <string.h>
+#include "net_client.h"
+#include "net_udp.h"
+#include "net_snapshot.h"
+#include "player_tank.h"
+#include "mount_system.h"
+
+// Local stand-in for one server entity
+typedef struct {
+    bool live;
+    Uint16 id;
+    NetEntityKind kind;
+    PlayerTank player;      // NET_KIND_TANK
+    Entity* entity;         // NET_KIND_BULLET
+} Replica;
+
+static NetSocket sock = { -1 };
+static NetAddress server;
+static bool connected = false;
+static Uint32 last_connect_sent = 0;
+
+static NetSnapshot history[NET_SNAPSHOT_HISTORY];   // received snapshots by tick
+static Uint32 latest_tick = 0;
+static Uint16 own_tank_id = 0;
+
+static Replica replicas[NET_MAX_SNAPSHOT_ENTITIES];
+
+static Replica* find_replica(Uint16 id) {
+    for (int i = 0; i < NET_MAX_SNAPSHOT_ENTITIES; i++) {
+        if (replicas[i].live && replicas[i].id == id) return &replicas[i];
+    }
+    return NULL;
+}
+
+static void destroy_replica(Replica* r) {
+    if (r->kind == NET_KIND_TANK) player_tank_destroy(&r->player);
+    else if (r->entity) entity_destroy(r->entity);
+    r->entity = NULL;
+    r->live = false;
+}
+
+static Replica* spawn_replica(SDL_Renderer* renderer, const NetEntityState* s) {
+    Replica* r = NULL;
+    for (int i = 0; i < NET_MAX_SNAPSHOT_ENTITIES && !r; i++) {
+        if (!replicas[i].live) r = &replicas[i];
+    }
+    if (!r) return NULL;
+
+    memset(r, 0, sizeof(*r));
+    r->id = s->id;
+    r->kind = (NetEntityKind)s->kind;
+    if (r->kind == NET_KIND_TANK) {
+        if (!player_tank_spawn(&r->player, renderer, 0, 0)) return NULL;
+    } else if (r->kind == NET_KIND_BULLET) {
+        r->entity = spawn_entity_of_type("bullet", ENTITY_BULLET, renderer, "assets/bullet.png", 0, 0);
+        if (!r->entity) return NULL;
+    } else {
+        return NULL;
+    }
+    r->live = true;
+    return r;
+}
+
+static void apply_tank(PlayerTank* p, const NetEntityState* s) {
+    net_state_apply(s, p->tank);
+    player_tank_set_engines(p, s->flags);
+
+    MountPoint* mp = mount_get(p->tank, "main_weapon");
+    if (mp) mp->offsets[0].angle = net_dequantize_angle(s->mount_angle);
+
+    // Same rule the server's toggle uses, so a dropped turret lands in the same spot
+    PlayerControls* pc = player_tank_controls(p);
+    bool mounted = s->flags & NET_FLAG_TURRET_MOUNTED;
+    if (mounted != pc->turret_mounted) {
+        if (mounted) {
+            mount_attach(p->tank, "main_weapon", p->turret);
+        } else {
+            mount_detach(p->tank, "main_weapon");
+            entity_set_position(p->turret, p->tank->x + 40, p->tank->y);
+        }
+        pc->turret_mounted = mounted;
+    }
+    mount_update_all(p->tank, 0.0f);
+}
+
+static void apply_snapshot(SDL_Renderer* renderer, const NetSnapshot* snap) {
+    // Gone from view, or the server reused the slot for something else
+    for (int i = 0; i < NET_MAX_SNAPSHOT_ENTITIES; i++) {
+        Replica* r = &replicas[i];
+        if (!r->live) continue;
+        const NetEntityState* s = net_snapshot_find(snap, r->id);
+        if (!s || s->kind != r->kind) destroy_replica(r);
+    }
+
+    for (int i = 0; i < snap->count; i++) {
+        const NetEntityState* s = &snap->entities[i];
+        Replica* r = find_replica(s->id);
+        if (!r) r = spawn_replica(renderer, s);
+        if (!r) continue;
+
+        if (r->kind == NET_KIND_TANK) apply_tank(&r->player, s);
+        else net_state_apply(s, r->entity);
+    }
+}
+
+static void handle_snapshot(SDL_Renderer* renderer, NetReader* r) {
+    Uint32 tick = net_read_u32(r);
+    Uint32 baseline = net_read_u32(r);
+    Uint16 own_id = net_read_u16(r);
+    if (r->error || tick <= latest_tick) return;   // late or duplicate
+
+    const NetSnapshot* base = NULL;
+    if (baseline) {
+        base = &history[baseline % NET_SNAPSHOT_HISTORY];
+        if (base->tick != baseline) return;   // we no longer have it; the next one will do
+    }
+
+    static NetSnapshot decoded;
+    if (!net_snapshot_decode(r, base, &decoded)) {
+        SDL_Log("Dropped malformed snapshot %u", tick);
+        return;
+    }
+    decoded.tick = tick;
+    history[tick % NET_SNAPSHOT_HISTORY] = decoded;
+    latest_tick = tick;
+    own_tank_id = own_id;
+
+    if (!connected) SDL_Log("Connected, first snapshot at tick %u", tick);
+    connected = true;
+    apply_snapshot(renderer, &decoded);
+}
+
+bool net_client_connect(const char* host, Uint16 default_port) {
+    if (!net_resolve(host, default_port, &server)) return false;
+    if (!net_socket_open(&sock, 0)) return false;
+
+    memset(history, 0, sizeof(history));
+    memset(replicas, 0, sizeof(replicas));
+    latest_tick = 0;
+    connected = false;
+    last_connect_sent = 0;
+    SDL_Log("Connecting to %s", host);
+    return true;
+}
+
+void net_client_update(SDL_Renderer* renderer, Uint8 input) {
+    if (sock.fd < 0) return;
+
+    Uint32 now = SDL_GetTicks();
+    Uint8 buf[NET_MAX_PACKET];
+    NetWriter w = { buf, 0, sizeof(buf), false };
+    if (!connected) {
+        if (now - last_connect_sent >= NET_CONNECT_RETRY_MS || last_connect_sent == 0) {
+            net_write_u8(&w, NET_MSG_CONNECT);
+            net_send(&sock, &server, buf, w.len);
+            last_connect_sent = now;
+        }
+    } else {
+        // Every input also acks the newest snapshot, which becomes the next baseline
+        net_write_u8(&w, NET_MSG_INPUT);
+        net_write_u32(&w, latest_tick);
+        net_write_u8(&w, input);
+        net_send(&sock, &server, buf, w.len);
+    }
+
+    NetAddress from;
+    int len;
+    while ((len = net_recv(&sock, &from, buf, sizeof(buf))) > 0) {
+        if (!net_address_equal(&from, &server)) continue;
+        NetReader r = { buf, len, 0, false };
+        if (net_read_u8(&r) == NET_MSG_SNAPSHOT)
+            handle_snapshot(renderer, &r);
+    }
+}
+
+Entity* net_client_own_tank(void) {
+    Replica* r = connected ? find_replica(own_tank_id) : NULL;
+    return (r && r->kind == NET_KIND_TANK) ? r->player.tank : NULL;
+}
+
+void net_client_render(SDL_Renderer* renderer) {
+    for (int i = 0; i < NET_MAX_SNAPSHOT_ENTITIES; i++) {
+        Replica* r = &replicas[i];
+        if (!r->live) continue;
+        if (r->kind == NET_KIND_TANK) {
+            Entity* tank = r->player.tank;
+            entity_render(renderer, tank, tank->width, tank->height);
+            mount_render_all(renderer, tank);
+        } else {
+            entity_render(renderer, r->entity, r->entity->width, r->entity->height);
+        }
+    }
+}
+
+void net_client_shutdown(void) {
+    if (sock.fd >= 0 && connected) {
+        Uint8 bye = NET_MSG_DISCONNECT;
+        net_send(&sock, &server, &bye, 1);
+    }
+    for (int i = 0; i < NET_MAX_SNAPSHOT_ENTITIES; i++) {
+        if (replicas[i].live) destroy_replica(&replicas[i]);
+    }
+    net_socket_close(&sock);
+    connected = false;
+}
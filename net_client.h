@@ -0,0 +1,24 @@
+#ifndef NET_CLIENT_H
+#define NET_CLIENT_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+#define NET_CONNECT_RETRY_MS 500
+
+// Render client of net_server: sends input, draws the server's state.
+// host is "name" or "name:port".
+bool net_client_connect(const char* host, Uint16 default_port);
+void net_client_shutdown(void);
+
+// Send this frame's input bits and apply any snapshots that arrived
+void net_client_update(SDL_Renderer* renderer, Uint8 input);
+
+// Our tank as last replicated, NULL until the first snapshot
+Entity* net_client_own_tank(void);
+
+// Replicated tanks (with mounts) and bullets
+void net_client_render(SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,322 @@
+#include <string.h>
+#include "net_server.h"
+#include "net_udp.h"
+#include "net_snapshot.h"
+#include "player_tank.h"
+#include "sdl_helpers.h"
+#include "asset_loader.h"
+#include "hitbox_loader.h"
+#include "camera.h"
+#include "world_chunks.h"
+#include "sim_state.h"
+#include "mount_system.h"
+#include "bullet.h"
+#include "command_buffer.h"
+
+#define NET_STATS_INTERVAL_MS 5000
+
+typedef struct {
+    bool connected;
+    NetAddress addr;
+    PlayerTank player;
+    Uint8 input;                // latest input bits, held until the next arrives
+    Uint32 last_heard;
+    Uint32 acked_tick;          // newest snapshot the client confirmed, 0 = none
+    NetSnapshot history[NET_SNAPSHOT_HISTORY];   // sent snapshots by tick
+    Uint32 bytes_sent;
+} NetClient;
+
+// Something that may go into a snapshot, with its distance to the viewer
+typedef struct {
+    const Entity* e;
+    const NetClient* owner;     // tanks only
+    NetEntityKind kind;
+    float dist2;
+} InterestCandidate;
+
+static NetClient clients[NET_MAX_CLIENTS];
+static NetSocket sock = { -1 };
+static SDL_Renderer* sim_renderer = NULL;
+static Uint32 server_tick = 0;
+
+static Uint16 net_id(const Entity* e) {
+    return (Uint16)e->slot;
+}
+
+static NetClient* find_client(const NetAddress* addr) {
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (clients[i].connected && net_address_equal(&clients[i].addr, addr))
+            return &clients[i];
+    }
+    return NULL;
+}
+
+static void drop_client(NetClient* c, const char* why) {
+    SDL_Log("Client %d %s", (int)(c - clients), why);
+    player_tank_destroy(&c->player);
+    c->connected = false;
+}
+
+static void accept_client(const NetAddress* addr) {
+    if (find_client(addr)) return;   // a repeated CONNECT
+
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        NetClient* c = &clients[i];
+        if (c->connected) continue;
+
+        memset(c, 0, sizeof(*c));
+        // Spread spawns so new tanks do not start on top of each other
+        if (!player_tank_spawn(&c->player, sim_renderer, 100.0f + 200.0f * i, 100.0f)) return;
+        c->connected = true;
+        c->addr = *addr;
+        c->last_heard = SDL_GetTicks();
+        SDL_Log("Client %d connected", i);
+        return;
+    }
+    SDL_Log("Server full, ignoring connect");
+}
+
+static void receive_packets(void) {
+    Uint8 buf[NET_MAX_PACKET];
+    NetAddress from;
+    int len;
+    while ((len = net_recv(&sock, &from, buf, sizeof(buf))) > 0) {
+        NetReader r = { buf, len, 0, false };
+        Uint8 type = net_read_u8(&r);
+
+        if (type == NET_MSG_CONNECT) {
+            accept_client(&from);
+            continue;
+        }
+
+        NetClient* c = find_client(&from);
+        if (!c) continue;
+        c->last_heard = SDL_GetTicks();
+
+        if (type == NET_MSG_INPUT) {
+            Uint32 ack = net_read_u32(&r);
+            Uint8 input = net_read_u8(&r);
+            if (r.error) continue;
+            // Acks only move forward; a stale packet must not rewind the baseline
+            if (ack > c->acked_tick && ack <= server_tick) c->acked_tick = ack;
+            c->input = input;
+        } else if (type == NET_MSG_DISCONNECT) {
+            drop_client(c, "disconnected");
+        }
+    }
+}
+
+// Nearest candidates within the interest radius, own tank first. The work
+// per client depends on tanks and bullets alive, never on world size.
+static void build_snapshot(const NetClient* c, NetSnapshot* out) {
+    static ARRAY(InterestCandidate) candidates;
+    if (!array_reserve(&candidates, NET_MAX_CLIENTS + sim.bullets.count)) {
+        SDL_Log("Out of memory building a snapshot");
+        out->tick = server_tick;
+        out->count = 0;
+        return;
+    }
+    InterestCandidate* cand = candidates.items;
+    int n = 0;
+
+    const Entity* me = c->player.tank;
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (!clients[i].connected) continue;
+        cand[n++] = (InterestCandidate){ clients[i].player.tank, &clients[i], NET_KIND_TANK, 0 };
+    }
+    for (int i = 0; i < sim.bullets.count; i++) {
+        if (!sim.bullets.items[i].active) continue;
+        cand[n++] = (InterestCandidate){ sim_entity(sim.bullets.items[i].entity), NULL, NET_KIND_BULLET, 0 };
+    }
+
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        float dx = cand[i].e->x - me->x;
+        float dy = cand[i].e->y - me->y;
+        cand[i].dist2 = dx * dx + dy * dy;
+        if (cand[i].dist2 <= NET_INTEREST_RADIUS * NET_INTEREST_RADIUS)
+            cand[kept++] = cand[i];
+    }
+
+    // Over the cap: partial selection sort keeps the nearest
+    if (kept > NET_MAX_SNAPSHOT_ENTITIES) {
+        for (int i = 0; i < NET_MAX_SNAPSHOT_ENTITIES; i++) {
+            int best = i;
+            for (int j = i + 1; j < kept; j++) {
+                if (cand[j].dist2 < cand[best].dist2) best = j;
+            }
+            InterestCandidate t = cand[i];
+            cand[i] = cand[best];
+            cand[best] = t;
+        }
+        kept = NET_MAX_SNAPSHOT_ENTITIES;
+    }
+
+    out->tick = server_tick;
+    out->count = kept;
+    for (int i = 0; i < kept; i++) {
+        NetEntityState* s = &out->entities[i];
+        net_state_from_entity(s, net_id(cand[i].e), cand[i].kind, cand[i].e);
+
+        const NetClient* owner = cand[i].owner;
+        if (owner) {
+            const PlayerTank* p = &owner->player;
+            s->flags = owner->input & (PLAYER_IN_THRUST | PLAYER_IN_LEFT | PLAYER_IN_RIGHT | PLAYER_IN_AFTERBURNER);
+            if (player_tank_controls(p)->turret_mounted) s->flags |= NET_FLAG_TURRET_MOUNTED;
+
+            MountPoint* mp = mount_get(p->tank, "main_weapon");
+            if (mp) s->mount_angle = net_quantize_angle(mp->offsets[0].angle);
+        }
+    }
+    net_snapshot_sort(out);
+}
+
+static void send_snapshot(NetClient* c) {
+    NetSnapshot* snap = &c->history[server_tick % NET_SNAPSHOT_HISTORY];
+    build_snapshot(c, snap);
+
+    // Delta against the newest snapshot the client has confirmed, if still kept
+    const NetSnapshot* base = NULL;
+    if (c->acked_tick && server_tick - c->acked_tick < NET_SNAPSHOT_HISTORY) {
+        const NetSnapshot* h = &c->history[c->acked_tick % NET_SNAPSHOT_HISTORY];
+        if (h->tick == c->acked_tick) base = h;
+    }
+
+    Uint8 buf[NET_MAX_PACKET];
+    NetWriter w = { buf, 0, sizeof(buf), false };
+    net_write_u8(&w, NET_MSG_SNAPSHOT);
+    net_write_u32(&w, server_tick);
+    net_write_u32(&w, base ? base->tick : 0);
+    net_write_u16(&w, net_id(c->player.tank));
+    net_snapshot_encode(&w, snap, base);
+
+    if (w.overflow) {
+        SDL_Log("Snapshot for client %d does not fit a packet", (int)(c - clients));
+        return;
+    }
+    if (net_send(&sock, &c->addr, buf, w.len))
+        c->bytes_sent += (Uint32)w.len;
+}
+
+static void server_tick_once(void) {
+    Camera views[NET_MAX_CLIENTS];
+    int view_count = 0;
+
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        NetClient* c = &clients[i];
+        if (!c->connected) continue;
+        player_tank_control(&c->player, c->input, FIXED_DT);
+
+        Camera* v = &views[view_count++];
+        camera_init(v, NET_VIEW_W, NET_VIEW_H);
+        v->x = c->player.tank->x;
+        v->y = c->player.tank->y;
+    }
+
+    // Scenery streams around every player, exactly as a client would see it
+    world_chunks_update_views(views, view_count);
+
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (clients[i].connected) player_tank_step(&clients[i].player, FIXED_DT);
+    }
+    update_all_bullets(FIXED_DT);
+    handle_all_collisions(FIXED_DT);
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (clients[i].connected) player_tank_settle(&clients[i].player, FIXED_DT);
+    }
+    command_apply(sim_renderer);
+
+    server_tick++;
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (clients[i].connected) send_snapshot(&clients[i]);
+    }
+}
+
+static void log_stats(Uint32 interval_ms) {
+    int connected = 0;
+    Uint32 bytes = 0;
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (!clients[i].connected) continue;
+        connected++;
+        bytes += clients[i].bytes_sent;
+        clients[i].bytes_sent = 0;
+    }
+    if (connected > 0) {
+        SDL_Log("Tick %u: %d clients, %u bytes/s per client", server_tick, connected,
+                (unsigned)(bytes * 1000u / interval_ms / (Uint32)connected));
+    }
+}
+
+int net_server_run(Uint16 port, float world_w, float world_h) {
+    SDL_Surface* target = NULL;
+    if (!init_sdl_headless(&target, &sim_renderer, 1, 1)) return 1;
+    if (!net_socket_open(&sock, port)) {
+        shutdown_game(NULL, sim_renderer, NULL, 0);
+        SDL_FreeSurface(target);
+        return 1;
+    }
+
+    world_set_bounds(world_w, world_h);
+    bullet_system_init();
+    memset(clients, 0, sizeof(clients));
+    server_tick = 0;
+
+    asset_loader_init(sim_renderer, 0);
+    hitbox_prefetch_all("hitboxes");
+    asset_request_image("assets/rock.png");
+    player_tank_prefetch();
+    hitbox_registry_build("hitboxes");
+    world_chunks_init(sim_renderer, "maps/rocks");
+
+    SDL_Log("Server listening on UDP port %u", port);
+
+    Uint32 last = SDL_GetTicks();
+    Uint32 last_stats = last;
+    float accumulator = 0.0f;
+    bool running = true;
+
+    while (running) {
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT) running = false;
+        }
+
+        receive_packets();
+
+        Uint32 now = SDL_GetTicks();
+        accumulator += (now - last) / 1000.0f;
+        last = now;
+
+        // Fixed ticks; a long stall catches up at most a few
+        int steps = 0;
+        while (accumulator >= FIXED_DT && steps < 4) {
+            server_tick_once();
+            accumulator -= FIXED_DT;
+            steps++;
+        }
+        if (steps == 4) accumulator = 0.0f;
+
+        for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+            if (clients[i].connected && now - clients[i].last_heard > NET_CLIENT_TIMEOUT_MS)
+                drop_client(&clients[i], "timed out");
+        }
+
+        if (now - last_stats >= NET_STATS_INTERVAL_MS) {
+            log_stats(now - last_stats);
+            last_stats = now;
+        }
+
+        if (accumulator < FIXED_DT) SDL_Delay(1);
+    }
+
+    for (int i = 0; i < NET_MAX_CLIENTS; i++) {
+        if (clients[i].connected) drop_client(&clients[i], "shut down");
+    }
+    cleanup_bullet_system();
+    world_chunks_shutdown();
+    net_socket_close(&sock);
+    shutdown_game(NULL, sim_renderer, NULL, 0);
+    SDL_FreeSurface(target);
+    sim_renderer = NULL;
+    return 0;
+}
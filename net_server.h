@@ -0,0 +1,18 @@
+#ifndef NET_SERVER_H
+#define NET_SERVER_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define NET_MAX_CLIENTS 8
+#define NET_INTEREST_RADIUS 1200.0f     // entities farther than this from a player are not sent
+#define NET_CLIENT_TIMEOUT_MS 5000
+#define NET_VIEW_W 1000                 // view each player streams chunks for
+#define NET_VIEW_H 750
+
+// Headless authoritative simulation: every connected client gets a tank
+// driven by its input, ticked at FIXED_DT, and a delta snapshot of what is
+// near it each tick. Returns when SDL_QUIT arrives (Ctrl-C).
+int net_server_run(Uint16 port, float world_w, float world_h);
+
+#endif
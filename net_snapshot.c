@@ -0,0 +1,282 @@
+#include <string.h>
+#include <math.h>
+#include "net_snapshot.h"
+
+// Field bits of a delta record
+enum {
+    FIELD_KIND  = 1 << 0,
+    FIELD_FLAGS = 1 << 1,
+    FIELD_X     = 1 << 2,
+    FIELD_Y     = 1 << 3,
+    FIELD_ANGLE = 1 << 4,
+    FIELD_SPEED = 1 << 5,
+    FIELD_MOUNT = 1 << 6,
+    FIELD_ALL   = 0x7f
+};
+
+// ---- Byte streams ----
+
+void net_write_u8(NetWriter* w, Uint8 v) {
+    if (w->len + 1 > w->cap) {
+        w->overflow = true;
+        return;
+    }
+    w->data[w->len++] = v;
+}
+
+void net_write_u16(NetWriter* w, Uint16 v) {
+    net_write_u8(w, (Uint8)v);
+    net_write_u8(w, (Uint8)(v >> 8));
+}
+
+void net_write_u32(NetWriter* w, Uint32 v) {
+    net_write_u16(w, (Uint16)v);
+    net_write_u16(w, (Uint16)(v >> 16));
+}
+
+Uint8 net_read_u8(NetReader* r) {
+    if (r->pos + 1 > r->len) {
+        r->error = true;
+        return 0;
+    }
+    return r->data[r->pos++];
+}
+
+Uint16 net_read_u16(NetReader* r) {
+    Uint16 lo = net_read_u8(r);
+    return (Uint16)(lo | (net_read_u8(r) << 8));
+}
+
+Uint32 net_read_u32(NetReader* r) {
+    Uint32 lo = net_read_u16(r);
+    return lo | ((Uint32)net_read_u16(r) << 16);
+}
+
+// Wrapping 16-bit difference, zigzagged so small negatives stay one byte
+static void write_delta(NetWriter* w, Uint16 cur, Uint16 base) {
+    Sint16 d = (Sint16)(Uint16)(cur - base);
+    Uint32 z = (Uint32)((d << 1) ^ (d >> 15)) & 0xffff;
+    while (z >= 0x80) {
+        net_write_u8(w, (Uint8)(z | 0x80));
+        z >>= 7;
+    }
+    net_write_u8(w, (Uint8)z);
+}
+
+static Uint16 read_delta(NetReader* r, Uint16 base) {
+    Uint32 z = 0;
+    for (int shift = 0; shift < 21; shift += 7) {
+        Uint8 b = net_read_u8(r);
+        z |= (Uint32)(b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+    }
+    Uint16 d = (Uint16)((z >> 1) ^ (0u - (z & 1)));
+    return (Uint16)(base + d);
+}
+
+// ---- Quantization ----
+
+static Uint16 quantize_pos(float v) {
+    float q = roundf((v + NET_POS_OFFSET) * NET_POS_SCALE);
+    if (q < 0.0f) q = 0.0f;
+    if (q > 65535.0f) q = 65535.0f;
+    return (Uint16)q;
+}
+
+static float dequantize_pos(Uint16 q) {
+    return q / NET_POS_SCALE - NET_POS_OFFSET;
+}
+
+Uint16 net_quantize_angle(float deg) {
+    float turns = deg / 360.0f;
+    turns -= floorf(turns);
+    return (Uint16)((Uint32)lroundf(turns * 65536.0f) & 0xffff);
+}
+
+float net_dequantize_angle(Uint16 q) {
+    float deg = q * (360.0f / 65536.0f);
+    // Mount angles are small signed offsets; keep them signed
+    return deg >= 180.0f ? deg - 360.0f : deg;
+}
+
+void net_state_from_entity(NetEntityState* s, Uint16 id, NetEntityKind kind, const Entity* e) {
+    memset(s, 0, sizeof(*s));
+    s->id = id;
+    s->kind = (Uint8)kind;
+    s->x = quantize_pos(e->x);
+    s->y = quantize_pos(e->y);
+    s->angle = net_quantize_angle(e->angle);
+
+    float speed = roundf(e->speed * NET_SPEED_SCALE);
+    if (speed < -32768.0f) speed = -32768.0f;
+    if (speed > 32767.0f) speed = 32767.0f;
+    s->speed = (Sint16)speed;
+}
+
+void net_state_apply(const NetEntityState* s, Entity* e) {
+    entity_set_position(e, dequantize_pos(s->x), dequantize_pos(s->y));
+    entity_set_angle(e, net_dequantize_angle(s->angle));
+    e->speed = s->speed / NET_SPEED_SCALE;
+}
+
+// ---- Snapshots ----
+
+const NetEntityState* net_snapshot_find(const NetSnapshot* snap, Uint16 id) {
+    int lo = 0, hi = snap->count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        Uint16 m = snap->entities[mid].id;
+        if (m == id) return &snap->entities[mid];
+        if (m < id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return NULL;
+}
+
+void net_snapshot_sort(NetSnapshot* snap) {
+    // Small and usually nearly sorted already
+    for (int i = 1; i < snap->count; i++) {
+        NetEntityState s = snap->entities[i];
+        int j = i - 1;
+        while (j >= 0 && snap->entities[j].id > s.id) {
+            snap->entities[j + 1] = snap->entities[j];
+            j--;
+        }
+        snap->entities[j + 1] = s;
+    }
+}
+
+static Uint8 changed_fields(const NetEntityState* cur, const NetEntityState* base) {
+    if (cur->kind != base->kind) return FIELD_ALL;   // slot reused: send it whole
+    Uint8 mask = 0;
+    if (cur->flags != base->flags)             mask |= FIELD_FLAGS;
+    if (cur->x != base->x)                     mask |= FIELD_X;
+    if (cur->y != base->y)                     mask |= FIELD_Y;
+    if (cur->angle != base->angle)             mask |= FIELD_ANGLE;
+    if (cur->speed != base->speed)             mask |= FIELD_SPEED;
+    if (cur->mount_angle != base->mount_angle) mask |= FIELD_MOUNT;
+    return mask;
+}
+
+static void write_record(NetWriter* w, const NetEntityState* cur, const NetEntityState* base, Uint8 mask) {
+    static const NetEntityState zero;
+    if (mask == FIELD_ALL) base = &zero;
+
+    net_write_u16(w, cur->id);
+    net_write_u8(w, mask);
+    if (mask & FIELD_KIND)  net_write_u8(w, cur->kind);
+    if (mask & FIELD_FLAGS) net_write_u8(w, cur->flags);
+    if (mask & FIELD_X)     write_delta(w, cur->x, base->x);
+    if (mask & FIELD_Y)     write_delta(w, cur->y, base->y);
+    if (mask & FIELD_ANGLE) write_delta(w, cur->angle, base->angle);
+    if (mask & FIELD_SPEED) write_delta(w, (Uint16)cur->speed, (Uint16)base->speed);
+    if (mask & FIELD_MOUNT) write_delta(w, cur->mount_angle, base->mount_angle);
+}
+
+void net_snapshot_encode(NetWriter* w, const NetSnapshot* cur, const NetSnapshot* base) {
+    static const NetSnapshot empty;
+    if (!base) base = &empty;
+
+    // Record count is patched in once known
+    int count_at = w->len;
+    net_write_u16(w, 0);
+    Uint16 records = 0;
+
+    Uint16 removed[NET_MAX_SNAPSHOT_ENTITIES];
+    int removed_count = 0;
+
+    int i = 0, j = 0;
+    while (i < cur->count || j < base->count) {
+        const NetEntityState* c = i < cur->count ? &cur->entities[i] : NULL;
+        const NetEntityState* b = j < base->count ? &base->entities[j] : NULL;
+
+        if (c && (!b || c->id < b->id)) {
+            write_record(w, c, NULL, FIELD_ALL);
+            records++;
+            i++;
+        } else if (b && (!c || b->id < c->id)) {
+            removed[removed_count++] = b->id;
+            j++;
+        } else {
+            Uint8 mask = changed_fields(c, b);
+            if (mask) {
+                write_record(w, c, b, mask);
+                records++;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    if (!w->overflow) {
+        w->data[count_at] = (Uint8)records;
+        w->data[count_at + 1] = (Uint8)(records >> 8);
+    }
+
+    net_write_u16(w, (Uint16)removed_count);
+    for (int k = 0; k < removed_count; k++)
+        net_write_u16(w, removed[k]);
+}
+
+bool net_snapshot_decode(NetReader* r, const NetSnapshot* base, NetSnapshot* out) {
+    static const NetSnapshot empty;
+    static const NetEntityState zero;
+    if (!base) base = &empty;
+
+    NetEntityState records[NET_MAX_SNAPSHOT_ENTITIES];
+    int record_count = net_read_u16(r);
+    if (record_count > NET_MAX_SNAPSHOT_ENTITIES) return false;
+
+    for (int k = 0; k < record_count && !r->error; k++) {
+        Uint16 id = net_read_u16(r);
+        Uint8 mask = net_read_u8(r);
+
+        const NetEntityState* b = net_snapshot_find(base, id);
+        if (mask == FIELD_ALL || !b) b = &zero;
+
+        NetEntityState* s = &records[k];
+        *s = *b;
+        s->id = id;
+        if (mask & FIELD_KIND)  s->kind = net_read_u8(r);
+        if (mask & FIELD_FLAGS) s->flags = net_read_u8(r);
+        if (mask & FIELD_X)     s->x = read_delta(r, b->x);
+        if (mask & FIELD_Y)     s->y = read_delta(r, b->y);
+        if (mask & FIELD_ANGLE) s->angle = read_delta(r, b->angle);
+        if (mask & FIELD_SPEED) s->speed = (Sint16)read_delta(r, (Uint16)b->speed);
+        if (mask & FIELD_MOUNT) s->mount_angle = read_delta(r, b->mount_angle);
+
+        // The encoder walks ids in order
+        if (k > 0 && records[k - 1].id >= id) return false;
+    }
+
+    Uint16 removed[NET_MAX_SNAPSHOT_ENTITIES];
+    int removed_count = net_read_u16(r);
+    if (removed_count > NET_MAX_SNAPSHOT_ENTITIES) return false;
+    for (int k = 0; k < removed_count; k++)
+        removed[k] = net_read_u16(r);
+    if (r->error) return false;
+
+    // Merge: base minus removals, overridden or extended by the records
+    int n = 0, i = 0, j = 0, k = 0;
+    while (i < base->count || j < record_count) {
+        const NetEntityState* b = i < base->count ? &base->entities[i] : NULL;
+        const NetEntityState* rec = j < record_count ? &records[j] : NULL;
+        const NetEntityState* pick;
+
+        if (rec && (!b || rec->id <= b->id)) {
+            if (b && b->id == rec->id) i++;
+            pick = rec;
+            j++;
+        } else {
+            while (k < removed_count && removed[k] < b->id) k++;
+            i++;
+            if (k < removed_count && removed[k] == b->id) continue;
+            pick = b;
+        }
+
+        if (n == NET_MAX_SNAPSHOT_ENTITIES) return false;
+        out->entities[n++] = *pick;
+    }
+    out->count = n;
+    return true;
+}
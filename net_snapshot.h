@@ -0,0 +1,84 @@
+#ifndef NET_SNAPSHOT_H
+#define NET_SNAPSHOT_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+#define NET_POS_SCALE 8.0f              // positions travel in 1/8 px
+#define NET_POS_OFFSET 1024.0f          // so slightly negative positions still fit a Uint16
+#define NET_SPEED_SCALE 16.0f           // speed in 1/16 px/s
+#define NET_MAX_SNAPSHOT_ENTITIES 48    // worst-case full snapshot stays under NET_MAX_PACKET
+#define NET_SNAPSHOT_HISTORY 32         // power of two; ticks a baseline can be acked late
+
+// First byte of every packet
+typedef enum {
+    NET_MSG_CONNECT = 1,    // client -> server, resent until a snapshot arrives
+    NET_MSG_INPUT,          // client -> server: acked tick u32, input bits u8
+    NET_MSG_DISCONNECT,     // client -> server
+    NET_MSG_SNAPSHOT,       // server -> client: tick u32, baseline u32, own tank id u16, delta
+} NetMessage;
+
+typedef enum {
+    NET_KIND_NONE,
+    NET_KIND_TANK,
+    NET_KIND_BULLET,
+} NetEntityKind;
+
+// Tank flags: the engine input bits plus whether the turret is mounted
+#define NET_FLAG_TURRET_MOUNTED 0x80
+
+// One replicated entity, already quantized. Snapshots compare these bytewise.
+typedef struct {
+    Uint16 id;
+    Uint8 kind;
+    Uint8 flags;
+    Uint16 x, y;
+    Uint16 angle;           // 1/65536 of a turn
+    Sint16 speed;
+    Uint16 mount_angle;     // tanks: MountOffset.angle of the main weapon
+} NetEntityState;
+
+// Entities sorted by id
+typedef struct {
+    Uint32 tick;
+    int count;
+    NetEntityState entities[NET_MAX_SNAPSHOT_ENTITIES];
+} NetSnapshot;
+
+// Little-endian packet building and parsing; overflow/error stick once set
+typedef struct {
+    Uint8* data;
+    int len, cap;
+    bool overflow;
+} NetWriter;
+
+typedef struct {
+    const Uint8* data;
+    int len, pos;
+    bool error;
+} NetReader;
+
+void   net_write_u8(NetWriter* w, Uint8 v);
+void   net_write_u16(NetWriter* w, Uint16 v);
+void   net_write_u32(NetWriter* w, Uint32 v);
+Uint8  net_read_u8(NetReader* r);
+Uint16 net_read_u16(NetReader* r);
+Uint32 net_read_u32(NetReader* r);
+
+// Quantization
+Uint16 net_quantize_angle(float deg);
+float  net_dequantize_angle(Uint16 q);
+void   net_state_from_entity(NetEntityState* s, Uint16 id, NetEntityKind kind, const Entity* e);
+void   net_state_apply(const NetEntityState* s, Entity* e);
+
+const NetEntityState* net_snapshot_find(const NetSnapshot* snap, Uint16 id);
+void net_snapshot_sort(NetSnapshot* snap);
+
+// Delta against base (NULL: against an empty snapshot). Unchanged entities
+// cost nothing, changed ones only their changed fields as small varints,
+// and entities that left carry just their id.
+void net_snapshot_encode(NetWriter* w, const NetSnapshot* cur, const NetSnapshot* base);
+bool net_snapshot_decode(NetReader* r, const NetSnapshot* base, NetSnapshot* out);
+
+#endif
@@ -0,0 +1,97 @@
+#define _POSIX_C_SOURCE 200112L
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "net_udp.h"
+
+bool net_socket_open(NetSocket* s, Uint16 port) {
+    s->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s->fd < 0) {
+        SDL_Log("socket failed: %s", strerror(errno));
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(s->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        SDL_Log("bind to port %u failed: %s", port, strerror(errno));
+        net_socket_close(s);
+        return false;
+    }
+
+    int flags = fcntl(s->fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(s->fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        SDL_Log("Failed to make socket non-blocking: %s", strerror(errno));
+        net_socket_close(s);
+        return false;
+    }
+    return true;
+}
+
+void net_socket_close(NetSocket* s) {
+    if (s->fd >= 0) close(s->fd);
+    s->fd = -1;
+}
+
+bool net_resolve(const char* host, Uint16 default_port, NetAddress* out) {
+    char name[256];
+    snprintf(name, sizeof(name), "%s", host);
+
+    Uint16 port = default_port;
+    char* colon = strrchr(name, ':');
+    if (colon) {
+        *colon = '\0';
+        port = (Uint16)atoi(colon + 1);
+    }
+
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(name, NULL, &hints, &res) != 0 || !res) {
+        SDL_Log("Cannot resolve %s", name);
+        return false;
+    }
+
+    out->host = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+    out->port = htons(port);
+    freeaddrinfo(res);
+    return true;
+}
+
+bool net_address_equal(const NetAddress* a, const NetAddress* b) {
+    return a->host == b->host && a->port == b->port;
+}
+
+bool net_send(NetSocket* s, const NetAddress* to, const void* data, int len) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = to->host;
+    addr.sin_port = to->port;
+    // A full send buffer drops the packet like the network would
+    return sendto(s->fd, data, (size_t)len, 0, (struct sockaddr*)&addr, sizeof(addr)) == len;
+}
+
+int net_recv(NetSocket* s, NetAddress* from, void* buf, int cap) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    ssize_t n = recvfrom(s->fd, buf, (size_t)cap, 0, (struct sockaddr*)&addr, &addr_len);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED) return 0;
+        SDL_Log("recvfrom failed: %s", strerror(errno));
+        return -1;
+    }
+    from->host = addr.sin_addr.s_addr;
+    from->port = addr.sin_port;
+    return (int)n;
+}
@@ -0,0 +1,32 @@
+#ifndef NET_UDP_H
+#define NET_UDP_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#define NET_DEFAULT_PORT 27960
+#define NET_MAX_PACKET 1400         // stays under a typical path MTU
+
+typedef struct {
+    Uint32 host;    // IPv4, network byte order
+    Uint16 port;    // network byte order
+} NetAddress;
+
+// Non-blocking IPv4 UDP socket
+typedef struct {
+    int fd;
+} NetSocket;
+
+// port 0 picks an ephemeral port (clients)
+bool net_socket_open(NetSocket* s, Uint16 port);
+void net_socket_close(NetSocket* s);
+
+// "host" or "host:port"; a missing port means default_port
+bool net_resolve(const char* host, Uint16 default_port, NetAddress* out);
+bool net_address_equal(const NetAddress* a, const NetAddress* b);
+
+bool net_send(NetSocket* s, const NetAddress* to, const void* data, int len);
+// Bytes read, 0 when nothing is waiting, -1 on error
+int  net_recv(NetSocket* s, NetAddress* from, void* buf, int cap);
+
+#endif
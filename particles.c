@@ -0,0 +1,396 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "particles.h"
+#include "mount_system.h"
+#include "camera.h"
+#include "dirty_rects.h"
+#include "fast_trig.h"
+
+#define SPAWN_BATCH 64
+
+static ParticleEmitter* emitters[MAX_EMITTERS];
+static int emitter_count = 0;
+static int budget_used = 0;
+
+// Shared quad index buffer (0,1,2, 2,3,0 per particle), sized for the largest emitter
+static int* quad_indices = NULL;
+static int quad_index_capacity = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+typedef float v4f __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+#define PARTICLES_SIMD 1
+
+// Lane-wise select through the compare mask; C has no vector ?:
+static inline v4f v4_min(v4f a, v4f b) {
+    v4i m = a < b;
+    return (v4f)(((v4i)a & m) | ((v4i)b & ~m));
+}
+
+static inline v4f v4_max(v4f a, v4f b) {
+    v4i m = a > b;
+    return (v4f)(((v4i)a & m) | ((v4i)b & ~m));
+}
+#endif
+
+static float rng_float(Uint32* state) {
+    // xorshift32; particles are cosmetic so they keep their own stream
+    Uint32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+static float rng_range(Uint32* state, float lo, float hi) {
+    return lo + (hi - lo) * rng_float(state);
+}
+
+static bool ensure_quad_indices(int capacity) {
+    if (capacity <= quad_index_capacity) return true;
+
+    int* grown = realloc(quad_indices, sizeof(int) * 6 * capacity);
+    if (!grown) return false;
+    for (int i = quad_index_capacity; i < capacity; i++) {
+        int v = i * 4;
+        grown[i * 6 + 0] = v + 0;
+        grown[i * 6 + 1] = v + 1;
+        grown[i * 6 + 2] = v + 2;
+        grown[i * 6 + 3] = v + 2;
+        grown[i * 6 + 4] = v + 3;
+        grown[i * 6 + 5] = v + 0;
+    }
+    quad_indices = grown;
+    quad_index_capacity = capacity;
+    return true;
+}
+
+ParticleEmitter* particle_emitter_create(const EmitterConfig* cfg, SDL_Texture* texture, int capacity) {
+    if (emitter_count >= MAX_EMITTERS) {
+        SDL_Log("Emitter limit reached.");
+        return NULL;
+    }
+
+    capacity = (capacity + 3) & ~3;
+    if (capacity <= 0 || budget_used + capacity > PARTICLE_BUDGET) {
+        SDL_Log("Particle budget exhausted (%d of %d in use)", budget_used, PARTICLE_BUDGET);
+        return NULL;
+    }
+    if (!ensure_quad_indices(capacity)) return NULL;
+
+    ParticleEmitter* em = calloc(1, sizeof(ParticleEmitter));
+    if (!em) return NULL;
+
+    // One aligned block holds all six arrays
+    size_t stride = sizeof(float) * capacity;
+    float* block = aligned_alloc(16, stride * 6);
+    em->verts = malloc(sizeof(SDL_Vertex) * 4 * capacity);
+    if (!block || !em->verts) {
+        free(block);
+        free(em->verts);
+        free(em);
+        return NULL;
+    }
+    memset(block, 0, stride * 6);
+
+    em->pool.x        = block;
+    em->pool.y        = block + capacity;
+    em->pool.vx       = block + capacity * 2;
+    em->pool.vy       = block + capacity * 3;
+    em->pool.age      = block + capacity * 4;
+    em->pool.inv_life = block + capacity * 5;
+    em->pool.capacity = capacity;
+
+    em->cfg = *cfg;
+    em->texture = texture;
+    em->rng = 0x9E3779B9u ^ (Uint32)(emitter_count + 1) * 2654435761u;
+
+    if (texture) SDL_SetTextureBlendMode(texture, cfg->blend);
+
+    emitters[emitter_count++] = em;
+    budget_used += capacity;
+    return em;
+}
+
+void particle_emitter_destroy(ParticleEmitter* em) {
+    if (!em) return;
+
+    for (int i = 0; i < emitter_count; i++) {
+        if (emitters[i] == em) {
+            emitters[i] = emitters[--emitter_count];
+            break;
+        }
+    }
+
+    budget_used -= em->pool.capacity;
+    free(em->pool.x);  // start of the shared block
+    free(em->verts);
+    free(em->mount_name);
+    free(em);
+}
+
+void particle_emitter_attach(ParticleEmitter* em, const Entity* parent, const char* mount_name) {
+    free(em->mount_name);
+    em->parent = parent;
+    em->mount_name = mount_name ? strdup(mount_name) : NULL;
+}
+
+void particle_emitter_set_origin(ParticleEmitter* em, float x, float y, float angle) {
+    em->x = x;
+    em->y = y;
+    em->angle = angle;
+}
+
+// Directions for a whole batch go through one vectorized sincos call
+static void spawn_batch(ParticleEmitter* em, float x, float y, float angle_deg, int count) {
+    ParticlePool* p = &em->pool;
+    const EmitterConfig* cfg = &em->cfg;
+    if (count > p->capacity - p->count) count = p->capacity - p->count;
+
+    float dir_sin[SPAWN_BATCH], dir_cos[SPAWN_BATCH];
+    while (count > 0) {
+        int n = (count < SPAWN_BATCH) ? count : SPAWN_BATCH;
+        int base = p->count;
+
+        // Speed parks in vx until the directions are known
+        for (int k = 0; k < n; k++) {
+            int i = base + k;
+            dir_cos[k] = angle_deg + cfg->angle_offset + rng_range(&em->rng, -cfg->spread_deg, cfg->spread_deg);
+            float speed = rng_range(&em->rng, cfg->speed_min, cfg->speed_max);
+            float life = rng_range(&em->rng, cfg->life_min, cfg->life_max);
+
+            p->x[i] = x;
+            p->y[i] = y;
+            p->vx[i] = speed;
+            p->age[i] = 0.0f;
+            p->inv_life[i] = (life > 0.0f) ? 1.0f / life : 1.0f;
+        }
+
+        fast_sincos_deg_batch(dir_cos, dir_sin, dir_cos, n);
+        for (int k = 0; k < n; k++) {
+            int i = base + k;
+            p->vy[i] = dir_sin[k] * p->vx[i];
+            p->vx[i] = dir_cos[k] * p->vx[i];
+        }
+
+        p->count += n;
+        count -= n;
+    }
+}
+
+void particle_emitter_burst(ParticleEmitter* em, float x, float y, float angle, int count) {
+    spawn_batch(em, x, y, angle, count);
+}
+
+// Integrate, age and bound four particles per step
+static void pool_integrate(ParticleEmitter* em, float dt) {
+    ParticlePool* p = &em->pool;
+    float damp = 1.0f - em->cfg.drag * dt;
+    if (damp < 0.0f) damp = 0.0f;
+
+    int n = (p->count + 3) & ~3;  // padding lanes hold stale data and are ignored
+    float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+    int i = 0;
+
+#ifdef PARTICLES_SIMD
+    v4f vdt = { dt, dt, dt, dt };
+    v4f vdamp = { damp, damp, damp, damp };
+    v4f vmin_x = { INFINITY, INFINITY, INFINITY, INFINITY }, vmin_y = vmin_x;
+    v4f vmax_x = -vmin_x, vmax_y = -vmin_x;
+    int full = p->count & ~3;
+
+    for (; i < n; i += 4) {
+        v4f x, y, vx, vy, age;
+        memcpy(&x, p->x + i, sizeof(v4f));
+        memcpy(&y, p->y + i, sizeof(v4f));
+        memcpy(&vx, p->vx + i, sizeof(v4f));
+        memcpy(&vy, p->vy + i, sizeof(v4f));
+        memcpy(&age, p->age + i, sizeof(v4f));
+
+        vx *= vdamp;
+        vy *= vdamp;
+        x += vx * vdt;
+        y += vy * vdt;
+        age += vdt;
+
+        memcpy(p->x + i, &x, sizeof(v4f));
+        memcpy(p->y + i, &y, sizeof(v4f));
+        memcpy(p->vx + i, &vx, sizeof(v4f));
+        memcpy(p->vy + i, &vy, sizeof(v4f));
+        memcpy(p->age + i, &age, sizeof(v4f));
+
+        if (i < full) {
+            vmin_x = v4_min(x, vmin_x);
+            vmin_y = v4_min(y, vmin_y);
+            vmax_x = v4_max(x, vmax_x);
+            vmax_y = v4_max(y, vmax_y);
+        }
+    }
+    for (int k = 0; k < 4; k++) {
+        min_x = fminf(min_x, vmin_x[k]);
+        min_y = fminf(min_y, vmin_y[k]);
+        max_x = fmaxf(max_x, vmax_x[k]);
+        max_y = fmaxf(max_y, vmax_y[k]);
+    }
+    i = full;  // bound the ragged tail below
+#else
+    for (; i < n; i++) {
+        p->vx[i] *= damp;
+        p->vy[i] *= damp;
+        p->x[i] += p->vx[i] * dt;
+        p->y[i] += p->vy[i] * dt;
+        p->age[i] += dt;
+    }
+    i = 0;
+#endif
+
+    for (; i < p->count; i++) {
+        min_x = fminf(min_x, p->x[i]);
+        min_y = fminf(min_y, p->y[i]);
+        max_x = fmaxf(max_x, p->x[i]);
+        max_y = fmaxf(max_y, p->y[i]);
+    }
+
+    em->min_x = min_x;
+    em->min_y = min_y;
+    em->max_x = max_x;
+    em->max_y = max_y;
+}
+
+// Swap-remove expired particles; order does not matter for additive/alpha dots
+static void pool_compact(ParticlePool* p) {
+    int i = 0;
+    while (i < p->count) {
+        if (p->age[i] * p->inv_life[i] >= 1.0f) {
+            int last = --p->count;
+            p->x[i] = p->x[last];
+            p->y[i] = p->y[last];
+            p->vx[i] = p->vx[last];
+            p->vy[i] = p->vy[last];
+            p->age[i] = p->age[last];
+            p->inv_life[i] = p->inv_life[last];
+        } else {
+            i++;
+        }
+    }
+}
+
+void particles_update_all(float dt) {
+    for (int e = 0; e < emitter_count; e++) {
+        ParticleEmitter* em = emitters[e];
+
+        pool_compact(&em->pool);
+
+        if (em->emitting && em->cfg.rate > 0.0f) {
+            float x = em->x, y = em->y, angle = em->angle;
+            if (em->parent && em->mount_name)
+                mount_get_world_position(em->parent, em->mount_name, &x, &y, &angle);
+
+            em->emit_accum += em->cfg.rate * dt;
+            int due = (int)em->emit_accum;
+            em->emit_accum -= (float)due;
+            spawn_batch(em, x, y, angle, due);
+        }
+
+        pool_integrate(em, dt);
+    }
+}
+
+static Uint8 lerp_u8(Uint8 a, Uint8 b, float t) {
+    return (Uint8)(a + (b - a) * t);
+}
+
+void particles_render_all(SDL_Renderer* renderer) {
+    const Camera* cam = camera_get_active();
+    float zoom = cam ? cam->zoom : 1.0f;
+    float off_x = cam ? cam->view_w / 2.0f - cam->x * zoom : 0.0f;
+    float off_y = cam ? cam->view_h / 2.0f - cam->y * zoom : 0.0f;
+
+    for (int e = 0; e < emitter_count; e++) {
+        ParticleEmitter* em = emitters[e];
+        const ParticlePool* p = &em->pool;
+        const EmitterConfig* cfg = &em->cfg;
+        if (p->count == 0 || !em->texture) continue;
+
+        // Whole-emitter cull from the bounds computed during update
+        float pad = fmaxf(cfg->size_start, cfg->size_end);
+        if (!camera_is_visible_rect(em->min_x - pad, em->min_y - pad, em->max_x + pad, em->max_y + pad))
+            continue;
+
+        SDL_Rect screen_bounds = {
+            (int)((em->min_x - pad) * zoom + off_x), (int)((em->min_y - pad) * zoom + off_y),
+            (int)((em->max_x - em->min_x + 2 * pad) * zoom) + 1, (int)((em->max_y - em->min_y + 2 * pad) * zoom) + 1
+        };
+        if (!dirty_rects_submit(&screen_bounds, NULL, 0.0f)) continue;
+
+        SDL_Vertex* v = em->verts;
+        for (int i = 0; i < p->count; i++, v += 4) {
+            float t = p->age[i] * p->inv_life[i];
+            if (t > 1.0f) t = 1.0f;
+            float half = 0.5f * zoom * (cfg->size_start + (cfg->size_end - cfg->size_start) * t);
+            float sx = p->x[i] * zoom + off_x;
+            float sy = p->y[i] * zoom + off_y;
+
+            SDL_Color c = {
+                lerp_u8(cfg->color_start.r, cfg->color_end.r, t),
+                lerp_u8(cfg->color_start.g, cfg->color_end.g, t),
+                lerp_u8(cfg->color_start.b, cfg->color_end.b, t),
+                lerp_u8(cfg->color_start.a, cfg->color_end.a, t)
+            };
+
+            v[0] = (SDL_Vertex){ { sx - half, sy - half }, c, { 0.0f, 0.0f } };
+            v[1] = (SDL_Vertex){ { sx + half, sy - half }, c, { 1.0f, 0.0f } };
+            v[2] = (SDL_Vertex){ { sx + half, sy + half }, c, { 1.0f, 1.0f } };
+            v[3] = (SDL_Vertex){ { sx - half, sy + half }, c, { 0.0f, 1.0f } };
+        }
+
+        SDL_RenderGeometry(renderer, em->texture, em->verts, p->count * 4, quad_indices, p->count * 6);
+    }
+}
+
+void particles_shutdown(void) {
+    while (emitter_count > 0)
+        particle_emitter_destroy(emitters[emitter_count - 1]);
+
+    free(quad_indices);
+    quad_indices = NULL;
+    quad_index_capacity = 0;
+}
+
+int particles_live_count(void) {
+    int total = 0;
+    for (int e = 0; e < emitter_count; e++)
+        total += emitters[e]->pool.count;
+    return total;
+}
+
+SDL_Texture* particle_texture_create(SDL_Renderer* renderer, int radius) {
+    int size = radius * 2;
+    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surf) {
+        SDL_Log("Failed to create particle surface: %s", SDL_GetError());
+        return NULL;
+    }
+
+    SDL_LockSurface(surf);
+    for (int y = 0; y < size; y++) {
+        Uint8* row = (Uint8*)surf->pixels + y * surf->pitch;
+        for (int x = 0; x < size; x++) {
+            float dx = (x + 0.5f - radius) / radius;
+            float dy = (y + 0.5f - radius) / radius;
+            float fall = 1.0f - sqrtf(dx * dx + dy * dy);
+            if (fall < 0.0f) fall = 0.0f;
+            row[x * 4 + 0] = 255;
+            row[x * 4 + 1] = 255;
+            row[x * 4 + 2] = 255;
+            row[x * 4 + 3] = (Uint8)(255.0f * fall * fall);
+        }
+    }
+    SDL_UnlockSurface(surf);
+
+    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
+    SDL_FreeSurface(surf);
+    return tex;
+}
@@ -0,0 +1,67 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+#define MAX_EMITTERS 32
+#define PARTICLE_BUDGET 65536   // particles across all emitters, allocated up front
+
+typedef struct {
+    float rate;                    // particles per second while emitting
+    float speed_min, speed_max;
+    float spread_deg;              // cone half-angle around the emit direction
+    float angle_offset;            // added to the mount angle (180 = backwards)
+    float life_min, life_max;      // seconds
+    float size_start, size_end;    // pixels
+    float drag;                    // fraction of velocity lost per second
+    SDL_Color color_start, color_end;
+    SDL_BlendMode blend;
+} EmitterConfig;
+
+// Structure-of-arrays particle state; capacity is a multiple of 4 and every
+// array is 16-byte aligned so the update runs four particles per step.
+typedef struct {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* age;
+    float* inv_life;
+    int count;
+    int capacity;
+} ParticlePool;
+
+typedef struct {
+    EmitterConfig cfg;
+    ParticlePool pool;
+    SDL_Texture* texture;          // one texture per emitter, one draw call per emitter
+
+    const Entity* parent;          // optional mount to follow
+    char* mount_name;
+    float x, y, angle;             // emit origin when not attached
+
+    bool emitting;
+    float emit_accum;
+    Uint32 rng;
+
+    float min_x, min_y, max_x, max_y;  // bounds from the last update, for culling
+    SDL_Vertex* verts;
+} ParticleEmitter;
+
+ParticleEmitter* particle_emitter_create(const EmitterConfig* cfg, SDL_Texture* texture, int capacity);
+void particle_emitter_destroy(ParticleEmitter* em);
+void particle_emitter_attach(ParticleEmitter* em, const Entity* parent, const char* mount_name);
+void particle_emitter_set_origin(ParticleEmitter* em, float x, float y, float angle);
+void particle_emitter_burst(ParticleEmitter* em, float x, float y, float angle, int count);
+
+void particles_update_all(float dt);
+void particles_render_all(SDL_Renderer* renderer);
+void particles_shutdown(void);
+int  particles_live_count(void);
+
+// Radial soft dot, white so emitters can tint it with vertex colors
+SDL_Texture* particle_texture_create(SDL_Renderer* renderer, int radius);
+
+#endif
@@ -0,0 +1,174 @@
+#include <string.h>
+#include "player_tank.h"
+#include "mount_system.h"
+#include "mount_helpers.h"
+#include "behavior_helpers.h"
+#include "entity_spawn_animated.h"
+#include "collision.h"
+#include "bullet.h"
+#include "asset_loader.h"
+#include "sim_state.h"
+
+void player_tank_prefetch(void) {
+    asset_request_image("assets/tank.png");
+    asset_request_image("assets/turret.png");
+    asset_request_image("assets/bullet.png");
+    prefetch_animated_frames("assets/exhaust-flame", 4);
+    prefetch_animated_frames("assets/burner", 16);
+}
+
+bool player_tank_spawn(PlayerTank* pt, SDL_Renderer* renderer, float x, float y) {
+    memset(pt, 0, sizeof(*pt));
+    pt->controls = -1;
+    for (int i = 0; i < SIM_MAX_PLAYERS && pt->controls < 0; i++) {
+        if (!sim.players[i].in_use) pt->controls = i;
+    }
+    if (pt->controls < 0) goto fail;
+    PlayerControls* pc = &sim.players[pt->controls];
+    memset(pc, 0, sizeof(*pc));
+    pc->in_use = true;
+    pc->turret_mounted = true;
+    pc->turret_remount_cooldown = 0.5f;
+
+    // ---- Tank Setup ----
+    pt->tank = spawn_entity("tank", renderer, "assets/tank.png", x, y);
+    if (!pt->tank) goto fail;
+    mount_system_init(pt->tank, TANK_MOUNT_SLOTS);
+
+    // ---- Turret Setup ----
+    pt->turret = spawn_entity("turret", renderer, "assets/turret.png", 0, 0);
+    if (!pt->turret) goto fail;
+    register_mount_and_attach(pt->tank, "main_weapon", -1, 40, 50, 0.0f, true, 0.0f, pt->turret);
+
+    // Exhaust Flame Component
+    pt->flame = spawn_animated_entity("main_motor_flame", renderer, "assets/exhaust-flame", 4, 0, 0);
+    if (!pt->flame) goto fail;
+    register_mount_and_attach_animated(pt->tank, "exhaust_flame", -1, -90, 0, 0.0f, true, 0.0f, pt->flame);
+
+    pt->right_burner = spawn_animated_entity("burner_right", renderer, "assets/burner", 16, 0, 0);
+    if (!pt->right_burner) goto fail;
+    register_mount_and_attach_animated(pt->tank, "right_burner", -1, -50, -78, 0.0f, true, 0.0f, pt->right_burner);
+
+    pt->left_burner = spawn_animated_entity("burner_left", renderer, "assets/burner", 16, 0, 0);
+    if (!pt->left_burner) goto fail;
+    register_mount_and_attach_animated(pt->tank, "left_burner", -1, -50, +78, 0.0f, true, 0.0f, pt->left_burner);
+
+    return true;
+
+fail:
+    SDL_Log("Failed to spawn player tank");
+    player_tank_destroy(pt);
+    return false;
+}
+
+void player_tank_destroy(PlayerTank* pt) {
+    Entity* parts[] = { pt->tank, pt->turret, pt->flame, pt->right_burner, pt->left_burner };
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        if (parts[i]) entity_destroy(parts[i]);
+    }
+    pt->tank = pt->turret = pt->flame = pt->right_burner = pt->left_burner = NULL;
+    if (pt->controls >= 0) sim.players[pt->controls].in_use = false;
+    pt->controls = -1;
+}
+
+PlayerControls* player_tank_controls(const PlayerTank* pt) {
+    return &sim.players[pt->controls];
+}
+
+Uint8 player_input_from_keyboard(const Uint8* keystate) {
+    Uint8 in = 0;
+    if (keystate[SDL_SCANCODE_UP])    in |= PLAYER_IN_THRUST;
+    if (keystate[SDL_SCANCODE_LEFT])  in |= PLAYER_IN_LEFT;
+    if (keystate[SDL_SCANCODE_RIGHT]) in |= PLAYER_IN_RIGHT;
+    if (keystate[SDL_SCANCODE_Z])     in |= PLAYER_IN_AFTERBURNER;
+    if (keystate[SDL_SCANCODE_SPACE]) in |= PLAYER_IN_FIRE;
+    if (keystate[SDL_SCANCODE_A])     in |= PLAYER_IN_TURRET_LEFT;
+    if (keystate[SDL_SCANCODE_D])     in |= PLAYER_IN_TURRET_RIGHT;
+    if (keystate[SDL_SCANCODE_T])     in |= PLAYER_IN_TURRET_TOGGLE;
+    return in;
+}
+
+void player_input_to_keystate(Uint8 input, Uint8 keys[SDL_NUM_SCANCODES]) {
+    memset(keys, 0, SDL_NUM_SCANCODES);
+    keys[SDL_SCANCODE_UP]    = (input & PLAYER_IN_THRUST) != 0;
+    keys[SDL_SCANCODE_LEFT]  = (input & PLAYER_IN_LEFT) != 0;
+    keys[SDL_SCANCODE_RIGHT] = (input & PLAYER_IN_RIGHT) != 0;
+    keys[SDL_SCANCODE_Z]     = (input & PLAYER_IN_AFTERBURNER) != 0;
+    keys[SDL_SCANCODE_SPACE] = (input & PLAYER_IN_FIRE) != 0;
+    keys[SDL_SCANCODE_A]     = (input & PLAYER_IN_TURRET_LEFT) != 0;
+    keys[SDL_SCANCODE_D]     = (input & PLAYER_IN_TURRET_RIGHT) != 0;
+    keys[SDL_SCANCODE_T]     = (input & PLAYER_IN_TURRET_TOGGLE) != 0;
+}
+
+void player_tank_set_engines(PlayerTank* pt, Uint8 input) {
+    bool moving = input & PLAYER_IN_THRUST;
+    bool afterburner_on = input & PLAYER_IN_AFTERBURNER;
+
+    pt->flame->active = moving || afterburner_on;
+    pt->left_burner->active = (input & PLAYER_IN_LEFT) || afterburner_on;
+    pt->right_burner->active = (input & PLAYER_IN_RIGHT) || afterburner_on;
+    if (pt->smoke) pt->smoke->emitting = moving || afterburner_on;
+}
+
+void player_tank_control(PlayerTank* pt, Uint8 input, float dt) {
+    Uint8 keystate[SDL_NUM_SCANCODES];
+    player_input_to_keystate(input, keystate);
+    Entity* tank = pt->tank;
+    PlayerControls* pc = player_tank_controls(pt);
+
+    apply_thrust_turn(tank, keystate, SDL_SCANCODE_UP, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, 1.0, 180, dt);
+    apply_afterburner(tank, keystate, SDL_SCANCODE_Z, 8, dt);
+    player_tank_set_engines(pt, input);
+
+    toggle_mount_with_key(pt->turret, tank, "main_weapon", keystate, SDL_SCANCODE_T, &pc->turret_mounted,
+                          &pc->turret_toggle_pressed, &pc->turret_remount_cooldown, 0.5f, dt);
+
+    rotate_within_limits(tank, "main_weapon", keystate, SDL_SCANCODE_A, SDL_SCANCODE_D, -20, 20, 4.0f, dt);
+    /* rotate_infinite(tank, "main_weapon", keystate, SDL_SCANCODE_A, SDL_SCANCODE_D, 1.0f, dt); */
+
+    // bullet shoot
+    pc->shoot_cooldown -= dt;
+    if (pc->shoot_cooldown < 0.0f) pc->shoot_cooldown = 0.0f;
+
+    bool fire = input & PLAYER_IN_FIRE;
+    if (fire && !pc->fire_pressed && pc->shoot_cooldown <= 0.0f && pc->turret_mounted) {
+        pc->fire_pressed = true;
+
+        // Get turret world position and angle
+        float turret_x, turret_y, turret_angle;
+        mount_get_world_position(tank, "main_weapon", &turret_x, &turret_y, &turret_angle);
+
+        // Calculate bullet spawn position (slightly in front of turret)
+        float spawn_distance = 30.0f;
+        float dir_sin, dir_cos;
+        fast_sincos_deg(turret_angle, &dir_sin, &dir_cos);
+        float bullet_x = turret_x + dir_cos * spawn_distance;
+        float bullet_y = turret_y + dir_sin * spawn_distance;
+
+        spawn_bullet(tank, bullet_x, bullet_y, turret_angle, 400.0f);
+
+        pc->shoot_cooldown = SHOOT_COOLDOWN_TIME;
+    }
+
+    if (!fire) {
+        pc->fire_pressed = false;
+    }
+}
+
+void player_tank_step(PlayerTank* pt, float dt) {
+    Entity* tank = pt->tank;
+    PlayerControls* pc = player_tank_controls(pt);
+
+    if (pc->turret_remount_cooldown > 0.0f) {
+        pc->turret_remount_cooldown -= dt;
+        if (pc->turret_remount_cooldown < 0.0f)
+            pc->turret_remount_cooldown = 0.0f;
+    }
+
+    entity_update(tank, NULL, dt);
+}
+
+float player_tank_settle(PlayerTank* pt, float dt) {
+    mount_update_all(pt->tank, dt);
+    return collision_last_impact(pt->tank);
+}
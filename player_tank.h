@@ -0,0 +1,69 @@
+#ifndef PLAYER_TANK_H
+#define PLAYER_TANK_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+#include "particles.h"
+
+#define SHOOT_COOLDOWN_TIME 0.2f    // 200ms between shots
+#define TANK_MOUNT_SLOTS 4
+
+// Controls as bits, so local keys and network input drive the same code
+typedef enum {
+    PLAYER_IN_THRUST      = 1 << 0,
+    PLAYER_IN_LEFT        = 1 << 1,
+    PLAYER_IN_RIGHT       = 1 << 2,
+    PLAYER_IN_AFTERBURNER = 1 << 3,
+    PLAYER_IN_FIRE        = 1 << 4,
+    PLAYER_IN_TURRET_LEFT = 1 << 5,
+    PLAYER_IN_TURRET_RIGHT= 1 << 6,
+    PLAYER_IN_TURRET_TOGGLE = 1 << 7,
+} PlayerInputBits;
+
+// Per-player control state that changes every tick; lives in sim.players
+typedef struct {
+    bool in_use;
+    bool turret_mounted;
+    bool turret_toggle_pressed;
+    float turret_remount_cooldown;
+    bool fire_pressed;
+    float shoot_cooldown;
+} PlayerControls;
+
+// A tank with its turret and engine effects mounted. The parts are pool
+// entities, so these pointers stay valid across a snapshot restore.
+typedef struct {
+    Entity* tank;
+    Entity* turret;
+    AnimatedEntity* flame;
+    AnimatedEntity* right_burner;
+    AnimatedEntity* left_burner;
+    ParticleEmitter* smoke;         // optional, set by the caller
+    int controls;                   // index into sim.players, -1 = none
+} PlayerTank;
+
+// Queue the tank's images on the decode pool ahead of the first spawn
+void player_tank_prefetch(void);
+
+bool player_tank_spawn(PlayerTank* pt, SDL_Renderer* renderer, float x, float y);
+void player_tank_destroy(PlayerTank* pt);
+PlayerControls* player_tank_controls(const PlayerTank* pt);
+
+// Input bits from the keyboard, and back to a keystate the behavior helpers read
+Uint8 player_input_from_keyboard(const Uint8* keystate);
+void  player_input_to_keystate(Uint8 input, Uint8 keys[SDL_NUM_SCANCODES]);
+
+// One FIXED_DT tick of controls: thrust, effects, turret and firing
+void player_tank_control(PlayerTank* pt, Uint8 input, float dt);
+
+// Integration; contacts are left to handle_all_collisions
+void player_tank_step(PlayerTank* pt, float dt);
+// After the contact pass: mounts follow the resolved hull. Returns the
+// hardest impact speed of the pass.
+float player_tank_settle(PlayerTank* pt, float dt);
+
+// Engine effects follow the thrust inputs (used for replicas too)
+void player_tank_set_engines(PlayerTank* pt, Uint8 input);
+
+#endif
@@ -0,0 +1,323 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include "rotation_cache.h"
+#include "growable.h"
+
+#define MAX_ROTATION_STEPS 256
+#define ROTATION_BINDING_MIN_SLOTS 64   // power of two
+
+// One entry per distinct source image; every texture uploaded from it
+// (e.g. one per bullet) binds to the same entry and shares its variants.
+typedef struct {
+    const void* key;      // the decoded surface the textures came from
+    SDL_Texture* variants[MAX_ROTATION_STEPS];
+    Uint32 last_used[MAX_ROTATION_STEPS];
+    Uint32* pixels;       // RGBA32 copy of the source
+    int w, h;
+    int size;             // side of the square variant (source diagonal)
+} RotationSource;
+
+typedef struct {
+    SDL_Texture* texture;
+    int source;
+} RotationBinding;
+
+#define BINDING_EMPTY ((SDL_Texture*)0)
+#define BINDING_TOMBSTONE ((SDL_Texture*)1)
+
+static ARRAY(RotationSource) sources;
+static ARRAY(RotationBinding) bindings;  // open addressed; count: table size, a power of two
+static int binding_count = 0;            // live bindings
+static int binding_filled = 0;           // live bindings plus tombstones
+static int rotation_steps = 0;
+static size_t budget = 0;
+static size_t bytes_used = 0;
+static Uint32 use_clock = 0;
+
+static Uint32 hash_ptr(const void* p) {
+    Uint64 v = (Uint64)(uintptr_t)p;
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    return (Uint32)v;
+}
+
+// Slot holding texture, or -1
+static int find_binding(SDL_Texture* texture) {
+    if (!bindings.count) return -1;
+    Uint32 mask = (Uint32)bindings.count - 1;
+    Uint32 i = hash_ptr(texture) & mask;
+    for (int n = 0; n < bindings.count; n++, i = (i + 1) & mask) {
+        if (bindings.items[i].texture == BINDING_EMPTY) return -1;
+        if (bindings.items[i].texture == texture) return (int)i;
+    }
+    return -1;
+}
+
+static void insert_binding(SDL_Texture* texture, int source) {
+    Uint32 mask = (Uint32)bindings.count - 1;
+    Uint32 i = hash_ptr(texture) & mask;
+    while (bindings.items[i].texture != BINDING_EMPTY && bindings.items[i].texture != BINDING_TOMBSTONE)
+        i = (i + 1) & mask;
+    if (bindings.items[i].texture == BINDING_EMPTY) binding_filled++;
+    bindings.items[i].texture = texture;
+    bindings.items[i].source = source;
+    binding_count++;
+}
+
+// Rebuild with room for one more binding at under half load; drops tombstones
+static bool rehash_bindings(void) {
+    int size = bindings.count ? bindings.count : ROTATION_BINDING_MIN_SLOTS;
+    while (2 * (binding_count + 1) > size) size *= 2;
+    RotationBinding* table = calloc(size, sizeof(RotationBinding));
+    if (!table) {
+        SDL_Log("Out of memory for %d rotation bindings", size);
+        return false;
+    }
+    RotationBinding* old = bindings.items;
+    int old_size = bindings.count;
+    bindings.items = table;
+    bindings.count = bindings.capacity = size;
+    binding_count = binding_filled = 0;
+    for (int i = 0; i < old_size; i++) {
+        if (old[i].texture != BINDING_EMPTY && old[i].texture != BINDING_TOMBSTONE)
+            insert_binding(old[i].texture, old[i].source);
+    }
+    free(old);
+    return true;
+}
+
+static bool add_binding(SDL_Texture* texture, int source) {
+    // Tombstones count toward the load, or probes for misses would never end
+    if (2 * (binding_filled + 1) > bindings.count && !rehash_bindings()) return false;
+    insert_binding(texture, source);
+    return true;
+}
+
+static int find_source_by_key(const void* key) {
+    for (int i = 0; i < sources.count; i++) {
+        if (sources.items[i].key == key) return i;
+    }
+    return -1;
+}
+
+static void free_variant(RotationSource* rs, int step) {
+    if (!rs->variants[step]) return;
+    SDL_DestroyTexture(rs->variants[step]);
+    rs->variants[step] = NULL;
+    bytes_used -= (size_t)rs->size * rs->size * 4;
+}
+
+// RGBA32 copy of source and the variant size it needs
+static bool copy_source_pixels(RotationSource* rs, SDL_Surface* source) {
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) return false;
+
+    rs->w = rgba->w;
+    rs->h = rgba->h;
+    rs->size = (int)ceilf(sqrtf((float)(rs->w * rs->w + rs->h * rs->h)));
+    rs->pixels = malloc(sizeof(Uint32) * rs->w * rs->h);
+    if (!rs->pixels) {
+        SDL_FreeSurface(rgba);
+        return false;
+    }
+
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < rs->h; y++)
+        memcpy(rs->pixels + y * rs->w, (Uint8*)rgba->pixels + y * rgba->pitch, sizeof(Uint32) * rs->w);
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+    return true;
+}
+
+bool rotation_cache_init(int steps, size_t budget_bytes) {
+    if (steps < 4) steps = 4;
+    if (steps > MAX_ROTATION_STEPS) steps = MAX_ROTATION_STEPS;
+    rotation_steps = steps;
+    budget = budget_bytes;
+    bytes_used = 0;
+    SDL_Log("Rotation cache: %d steps, %zu KB budget", steps, budget_bytes / 1024);
+    return true;
+}
+
+bool rotation_cache_enabled(void) {
+    return rotation_steps > 0;
+}
+
+bool rotation_cache_wanted(SDL_Renderer* renderer, int* steps) {
+    *steps = ROTATION_CACHE_DEFAULT_STEPS;
+
+    const char* env = SDL_getenv("TANK_ROTATION_CACHE");
+    if (env) {
+        *steps = atoi(env);
+        return *steps > 0;
+    }
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) != 0) return false;
+    return (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+}
+
+void rotation_cache_register(SDL_Texture* texture, SDL_Surface* source) {
+    if (!rotation_cache_enabled() || !texture || !source) return;
+    if (find_binding(texture) >= 0) return;
+
+    int idx = find_source_by_key(source);
+    if (idx < 0) {
+        if (!array_reserve(&sources, sources.count + 1)) {
+            SDL_Log("Out of memory for rotation source");
+            return;
+        }
+        RotationSource* rs = &sources.items[sources.count];
+        memset(rs, 0, sizeof(*rs));
+        if (!copy_source_pixels(rs, source)) return;
+
+        rs->key = source;
+        idx = sources.count++;
+    }
+
+    // Unbound textures are simply drawn with SDL's own rotation
+    add_binding(texture, idx);
+}
+
+void rotation_cache_replace_source(const SDL_Surface* old_source, SDL_Surface* new_source) {
+    int idx = find_source_by_key(old_source);
+    if (idx < 0) return;
+
+    // Bound textures keep their source index and pick up the new pixels
+    RotationSource* rs = &sources.items[idx];
+    for (int s = 0; s < rotation_steps; s++)
+        free_variant(rs, s);
+    free(rs->pixels);
+    rs->pixels = NULL;
+    rs->w = rs->h = rs->size = 0;
+    copy_source_pixels(rs, new_source);
+    rs->key = new_source;
+}
+
+void rotation_cache_forget(SDL_Texture* texture) {
+    int slot = find_binding(texture);
+    if (slot < 0) return;
+
+    // Variants stay with the source for the next texture of the same image
+    bindings.items[slot].texture = BINDING_TOMBSTONE;
+    binding_count--;
+}
+
+void rotation_cache_shutdown(void) {
+    for (int i = 0; i < sources.count; i++) {
+        for (int s = 0; s < rotation_steps; s++)
+            free_variant(&sources.items[i], s);
+        free(sources.items[i].pixels);
+    }
+    array_free(&sources);
+    array_free(&bindings);
+    binding_count = binding_filled = 0;
+    rotation_steps = 0;
+    bytes_used = 0;
+}
+
+// Drop the least recently used variant of any source
+static bool evict_one(void) {
+    RotationSource* victim = NULL;
+    int victim_step = -1;
+    Uint32 oldest = 0;
+
+    for (int i = 0; i < sources.count; i++) {
+        for (int s = 0; s < rotation_steps; s++) {
+            if (!sources.items[i].variants[s]) continue;
+            Uint32 age = use_clock - sources.items[i].last_used[s];
+            if (!victim || age > oldest) {
+                victim = &sources.items[i];
+                victim_step = s;
+                oldest = age;
+            }
+        }
+    }
+    if (!victim) return false;
+    free_variant(victim, victim_step);
+    return true;
+}
+
+static SDL_Texture* build_variant(SDL_Renderer* renderer, RotationSource* rs, int step) {
+    size_t bytes = (size_t)rs->size * rs->size * 4;
+    if (bytes > budget) return NULL;
+    while (bytes_used + bytes > budget) {
+        if (!evict_one()) return NULL;
+    }
+
+    SDL_Surface* out = SDL_CreateRGBSurfaceWithFormat(0, rs->size, rs->size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!out) return NULL;
+
+    // Inverse-map each destination pixel into the source (nearest sample).
+    // SDL rotates clockwise on screen, so sample with the opposite angle.
+    double rad = step * (2.0 * M_PI / rotation_steps);
+    float c = (float)cos(rad);
+    float s = (float)sin(rad);
+    float half_out = rs->size / 2.0f;
+    float half_w = rs->w / 2.0f;
+    float half_h = rs->h / 2.0f;
+
+    SDL_LockSurface(out);
+    for (int y = 0; y < rs->size; y++) {
+        Uint32* row = (Uint32*)((Uint8*)out->pixels + y * out->pitch);
+        float dy = y + 0.5f - half_out;
+        for (int x = 0; x < rs->size; x++) {
+            float dx = x + 0.5f - half_out;
+            int sx = (int)floorf(c * dx + s * dy + half_w);
+            int sy = (int)floorf(-s * dx + c * dy + half_h);
+            row[x] = (sx >= 0 && sx < rs->w && sy >= 0 && sy < rs->h) ? rs->pixels[sy * rs->w + sx] : 0;
+        }
+    }
+    SDL_UnlockSurface(out);
+
+    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, out);
+    SDL_FreeSurface(out);
+    if (!tex) return NULL;
+
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    bytes_used += bytes;
+    return tex;
+}
+
+bool rotation_cache_draw(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* dst, double angle) {
+    if (!rotation_cache_enabled()) return false;
+
+    int slot = find_binding(texture);
+    if (slot < 0) return false;
+    RotationSource* rs = &sources.items[bindings.items[slot].source];
+    if (!rs->pixels) return false;
+
+    double norm = fmod(angle, 360.0);
+    if (norm < 0) norm += 360.0;
+    int step = (int)floor(norm * rotation_steps / 360.0 + 0.5) % rotation_steps;
+
+    // Step 0 is the source itself
+    if (step == 0) {
+        SDL_RenderCopy(renderer, texture, NULL, dst);
+        return true;
+    }
+
+    use_clock++;
+    if (!rs->variants[step]) {
+        rs->variants[step] = build_variant(renderer, rs, step);
+        if (!rs->variants[step]) return false;
+    }
+    rs->last_used[step] = use_clock;
+
+    // Variants are stored at source scale; keep the caller's zoom
+    float scale_x = (float)dst->w / rs->w;
+    float scale_y = (float)dst->h / rs->h;
+    int out_w = (int)(rs->size * scale_x);
+    int out_h = (int)(rs->size * scale_y);
+    SDL_Rect out = {
+        dst->x + dst->w / 2 - out_w / 2,
+        dst->y + dst->h / 2 - out_h / 2,
+        out_w,
+        out_h
+    };
+    SDL_RenderCopy(renderer, rs->variants[step], NULL, &out);
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef ROTATION_CACHE_H
+#define ROTATION_CACHE_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ROTATION_CACHE_DEFAULT_STEPS 64
+#define ROTATION_CACHE_DEFAULT_BUDGET (48u * 1024u * 1024u)   // bytes of rotated pixels
+
+// Software renderers rotate per pixel on every RenderCopyEx; this cache
+// keeps pre-rotated copies of each sprite at a fixed angular resolution
+// and blits the nearest one instead. Variants are built lazily on first
+// use and evicted least-recently-used once the budget is exceeded.
+bool rotation_cache_init(int steps, size_t budget_bytes);
+void rotation_cache_shutdown(void);
+bool rotation_cache_enabled(void);
+
+// True when the renderer is the software fallback (or TANK_ROTATION_CACHE forces it)
+bool rotation_cache_wanted(SDL_Renderer* renderer, int* steps);
+
+// Remember the source pixels of a texture; call right after creating it
+void rotation_cache_register(SDL_Texture* texture, SDL_Surface* source);
+// Drop variants before the texture is destroyed
+void rotation_cache_forget(SDL_Texture* texture);
+// A reloaded image: drop the old variants and rebind every texture of it
+void rotation_cache_replace_source(const SDL_Surface* old_source, SDL_Surface* new_source);
+
+// Blit the nearest pre-rotated variant centered on dst; false means the
+// caller should fall back to SDL_RenderCopyEx
+bool rotation_cache_draw(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* dst, double angle);
+
+#endif
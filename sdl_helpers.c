@@ -2,6 +2,9 @@
 #include <SDL_image.h>
 #include <SDL.h>
 #include "entity.h"
+#include "asset_loader.h"
+#include "hitbox_loader.h"
+#include "rotation_cache.h"
 
 bool init_sdl(SDL_Window** window, SDL_Renderer** renderer, int width, int height) {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
@@ -34,6 +37,29 @@ bool init_sdl(SDL_Window** window, SDL_Renderer** renderer, int width, int heigh
     return true;
 }
 
+bool init_sdl_headless(SDL_Surface** target, SDL_Renderer** renderer, int width, int height) {
+    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0) {
+        SDL_Log("SDL_Init Error: %s", SDL_GetError());
+        return false;
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        SDL_Log("IMG_Init Error: %s", IMG_GetError());
+        SDL_Quit();
+        return false;
+    }
+
+    *target = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    *renderer = *target ? SDL_CreateSoftwareRenderer(*target) : NULL;
+    if (!*renderer) {
+        SDL_Log("Headless renderer Error: %s", SDL_GetError());
+        if (*target) SDL_FreeSurface(*target);
+        IMG_Quit(); SDL_Quit(); return false;
+    }
+
+    return true;
+}
+
 void shutdown_game(SDL_Window* window, SDL_Renderer* renderer, Entity** entities, int entity_count) {
     for (int i = 0; i < entity_count; i++) {
         if (entities[i]) {
@@ -41,6 +67,14 @@ void shutdown_game(SDL_Window* window, SDL_Renderer* renderer, Entity** entities
             entity_destroy(entities[i]);
         }
     }
+    // Everything else, plus the cold data destroyed entities leave behind
+    entity_pool_shutdown();
+
+    hitbox_registry_clear();
+
+    // Joins the decode workers and frees any textures nobody took
+    asset_loader_shutdown();
+    rotation_cache_shutdown();
 
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
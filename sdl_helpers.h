@@ -6,6 +6,11 @@
 #include "entity.h"
 
 bool init_sdl(SDL_Window** window, SDL_Renderer** renderer, int width, int height);
+
+// No window: a software renderer on an offscreen surface, so textures, sizes
+// and hitboxes load exactly as they do with a display. A 1x1 target clips
+// every draw; a window-sized one renders for real (benchmarks).
+bool init_sdl_headless(SDL_Surface** target, SDL_Renderer** renderer, int width, int height);
 void shutdown_game(SDL_Window* window, SDL_Renderer* renderer, Entity** entities, int entity_count);
 
 #define REGISTER_ENTITY(varname, spawn_call)             \
@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim_state.h"
+#include "world_chunks.h"
+
+SimState sim;
+
+static SimState history[SIM_ROLLBACK_FRAMES];
+static bool history_valid[SIM_ROLLBACK_FRAMES];
+
+bool sim_state_copy(SimState* dst, const SimState* src) {
+    if (dst == src) return true;
+
+    // Grow everything before writing anything, so a failure leaves dst as
+    // it was instead of half copied (a failed restore must not touch sim)
+    if (!pool_reserve(&dst->entities, src->entity_count) ||
+        !pool_reserve(&dst->links, src->entity_count) ||
+        !array_reserve(&dst->free_slots, src->free_slots.count) ||
+        !array_reserve(&dst->colliders, src->colliders.count) ||
+        !array_reserve(&dst->pairs, src->pairs.count) ||
+        !array_reserve(&dst->bullets, src->bullets.count))
+        return false;
+
+    SimState keep = *dst;   // dst's own storage
+    memcpy(dst, src, sizeof(SimState));
+    dst->entities = keep.entities;
+    dst->links = keep.links;
+    dst->free_slots = keep.free_slots;
+    dst->colliders = keep.colliders;
+    dst->pairs = keep.pairs;
+    dst->bullets = keep.bullets;
+
+    // Already grown, so these cannot fail
+    pool_copy_from(&dst->entities, &src->entities, src->entity_count);
+    pool_copy_from(&dst->links, &src->links, src->entity_count);
+    // Slots past entity_count keep stale data; every walk stops at
+    // entity_count and entity_alloc clears a slot before handing it out
+
+    memcpy(dst->free_slots.items, src->free_slots.items, sizeof(Sint16) * src->free_slots.count);
+    dst->free_slots.count = src->free_slots.count;
+
+    memcpy(dst->colliders.items, src->colliders.items, sizeof(ColliderComponent) * src->colliders.count);
+    dst->colliders.count = src->colliders.count;
+
+    memcpy(dst->pairs.items, src->pairs.items, sizeof(ContactPair) * src->pairs.count);
+    dst->pairs.count = src->pairs.count;
+
+    memcpy(dst->bullets.items, src->bullets.items, sizeof(Bullet) * src->bullets.count);
+    dst->bullets.count = src->bullets.count;
+    return true;
+}
+
+size_t sim_state_bytes(const SimState* s) {
+    return sizeof(SimState) + (sizeof(Entity) + sizeof(EntityLinks)) * s->entity_count +
+           sizeof(Sint16) * s->free_slots.count + sizeof(ColliderComponent) * s->colliders.count +
+           sizeof(ContactPair) * s->pairs.count +
+           sizeof(Bullet) * s->bullets.count;
+}
+
+void sim_state_save(void) {
+    int i = sim.tick % SIM_ROLLBACK_FRAMES;
+    history_valid[i] = sim_state_copy(&history[i], &sim);
+    if (!history_valid[i]) SDL_Log("Out of memory saving tick %u", sim.tick);
+}
+
+bool sim_state_restore(Uint32 tick) {
+    int i = tick % SIM_ROLLBACK_FRAMES;
+    if (!history_valid[i] || history[i].tick != tick) return false;
+    if (!sim_state_copy(&sim, &history[i])) return false;
+
+    // Caches built from simulation state
+    entity_pool_check_restored();
+    world_chunks_resync();
+    return true;
+}
+
+void sim_state_clear_history(void) {
+    memset(history_valid, 0, sizeof(history_valid));
+}
+
+int sim_rollback_check_depth(void) {
+    const char* env = SDL_getenv("TANK_ROLLBACK_CHECK");
+    int depth = env ? atoi(env) : 0;
+    if (depth < 0) depth = 0;
+    if (depth > SIM_ROLLBACK_FRAMES - 1) depth = SIM_ROLLBACK_FRAMES - 1;
+    return depth;
+}
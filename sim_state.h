@@ -0,0 +1,77 @@
+#ifndef SIM_STATE_H
+#define SIM_STATE_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+#include "mount_system.h"
+#include "collision.h"
+#include "bullet.h"
+#include "player_tank.h"
+#include "growable.h"
+
+#define SIM_ROLLBACK_FRAMES 16      // ticks kept for rollback
+#define SIM_MAX_PLAYERS 16
+#define SIM_MAX_CHUNKS 256
+
+// Every piece of mutable simulation state. Records refer to each other by
+// pool slot, never by address, so a tick is saved and restored by copying
+// the fixed part and the used prefix of each container (sim_state_copy).
+// Textures, names, hitbox geometry and contact handlers are shared
+// read-only data and stay outside.
+typedef struct {
+    Uint32 tick;
+
+    // Entity pool: paged, so Entity pointers survive growth
+    POOL(Entity) entities;
+    POOL(EntityLinks) links;
+    ARRAY(Sint16) free_slots;           // FIFO, so a freed slot is reused as late as possible
+    int free_head;                      // free_slots.items[free_head .. count) are free
+    int entity_count;                   // slots ever handed out
+
+    MountPoint mounts[MAX_MOUNT_POINTS];
+
+    // Collision; colliders.count is the live count
+    ARRAY(ColliderComponent) colliders;
+    ARRAY(ContactPair) pairs;           // open addressed; count: table size, a power of two
+    int pair_count;                     // slots in use
+    Uint32 contact_tick;
+
+    ARRAY(Bullet) bullets;              // count: one past the highest slot in use
+
+    PlayerControls players[SIM_MAX_PLAYERS];
+
+    bool chunk_loaded[SIM_MAX_CHUNKS];
+} SimState;
+
+extern SimState sim;
+
+static inline Entity* sim_entity(int slot) {
+    return slot >= 0 ? pool_at(&sim.entities, slot) : NULL;
+}
+
+static inline EntityLinks* sim_link(int slot) {
+    return pool_at(&sim.links, slot);
+}
+
+static inline EntityLinks* sim_links(const Entity* e) {
+    return sim_link(e->slot);
+}
+
+// Deep copy into dst, which keeps (and grows) its own containers. Entity
+// pages of dst are written in place, so pointers into sim stay valid
+// across a restore. False if dst could not grow, and then dst is unchanged.
+bool sim_state_copy(SimState* dst, const SimState* src);
+size_t sim_state_bytes(const SimState* s);     // what one copy moves
+
+// Copy the current state into the ring under sim.tick
+void sim_state_save(void);
+// Bring back the state saved for tick; false once it has left the ring
+bool sim_state_restore(Uint32 tick);
+void sim_state_clear_history(void);
+
+// TANK_ROLLBACK_CHECK=<ticks>: every tick, roll back that many ticks and
+// resimulate them (0 when unset). Clamped to the ring.
+int sim_rollback_check_depth(void);
+
+#endif
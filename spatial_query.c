@@ -0,0 +1,551 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "spatial_query.h"
+#include "collision.h"
+#include "camera.h"
+#include "sim_state.h"
+
+// One active collider as of the last rebuild
+typedef struct {
+    Sint16 slot;
+    Uint32 layer;
+    float x, y, r;              // bounding circle
+    const SDL_Point* local;     // shared registry geometry, NULL for circle-only
+    int local_count;
+    int outline;                // offset into outline_pool once transformed, -1 before
+    Uint32 seen;                // query stamp, so multi-cell items are tested once
+} SpatialItem;
+
+static SpatialItem* items = NULL;
+static int item_count = 0;
+static int items_capacity = 0;
+
+// Grid in compressed rows: the items of cell c are cell_items[cell_start[c] .. cell_start[c + 1])
+static int grid_w = 0, grid_h = 0;
+static float origin_x = 0, origin_y = 0;
+static int* cell_index = NULL;        // cell_start and cell_cursor share one block
+static int cell_index_capacity = 0;
+static int* cell_start = NULL;
+static int* cell_cursor = NULL;
+static int* cell_items = NULL;
+static int cell_items_capacity = 0;
+
+// World-space outlines, transformed on first use after a rebuild
+static SDL_Point* outline_pool = NULL;
+static int outline_capacity = 0;
+static int outline_used = 0;
+
+static Uint32 query_stamp = 0;
+
+// One ray's grid walk (Amanatides-Woo), with its nearest hit so far
+typedef struct {
+    float dx, dy;
+    float t1;                   // where the segment leaves the grid
+    int cx, cy, step_x, step_y;
+    float delta_x, delta_y, next_x, next_y;
+    float best_t;
+} RayWalk;
+
+// A batched ray keyed by the cell its walk starts in
+typedef struct {
+    int cell;
+    int ray;
+} BatchRay;
+
+static RayWalk* batch_walks = NULL;
+static int batch_walks_capacity = 0;
+static BatchRay* batch_order = NULL;
+static int batch_order_capacity = 0;
+
+static int clamp_cell(int v, int n) {
+    return v < 0 ? 0 : (v >= n ? n - 1 : v);
+}
+
+static int cell_x(float x) {
+    return clamp_cell((int)floorf((x - origin_x) / SPATIAL_CELL_SIZE), grid_w);
+}
+
+static int cell_y(float y) {
+    return clamp_cell((int)floorf((y - origin_y) / SPATIAL_CELL_SIZE), grid_h);
+}
+
+void spatial_rebuild(void) {
+    WorldBounds wb = world_get_bounds();
+    origin_x = wb.min_x;
+    origin_y = wb.min_y;
+    grid_w = (int)ceilf((wb.max_x - wb.min_x) / SPATIAL_CELL_SIZE);
+    grid_h = (int)ceilf((wb.max_y - wb.min_y) / SPATIAL_CELL_SIZE);
+    if (grid_w < 1) grid_w = 1;
+    if (grid_h < 1) grid_h = 1;
+
+    int cells = grid_w * grid_h;
+    if (!array_grow((void**)&cell_index, &cell_index_capacity, 2 * (cells + 1), sizeof(int)) ||
+        !array_grow((void**)&items, &items_capacity, sim.colliders.count, sizeof(SpatialItem))) {
+        SDL_Log("Spatial grid: out of memory");
+        item_count = 0;
+        grid_w = grid_h = 0;
+        return;
+    }
+    cell_start = cell_index;
+    cell_cursor = cell_index + cells + 1;
+
+    // Items and their outline space
+    item_count = 0;
+    int points = 0;
+    for (int i = 0; i < sim.colliders.count; i++) {
+        const ColliderComponent* c = &sim.colliders.items[i];
+        const Entity* e = sim_entity(c->entity);
+        if (!e->active) continue;
+
+        SpatialItem* it = &items[item_count++];
+        it->slot = c->entity;
+        it->layer = c->layer;
+        if (c->type == COLLIDER_CIRCLE) {
+            // Exact already; the item circle is the collider itself
+            collider_circle_center(c, e, &it->x, &it->y);
+            it->r = c->circle.radius;
+        } else {
+            it->x = e->x;
+            it->y = e->y;
+            // transform_polygon truncates to whole pixels, so allow one more
+            it->r = 0.5f * sqrtf((float)(e->width * e->width + e->height * e->height)) + 1.0f;
+        }
+        bool polygon = c->type == COLLIDER_POLYGON && c->polygon.point_count >= 3;
+        it->local = polygon ? c->polygon.points : NULL;
+        it->local_count = polygon ? c->polygon.point_count : 0;
+        it->outline = -1;
+        it->seen = 0;
+        points += it->local_count;
+    }
+    outline_used = 0;
+    if (!array_grow((void**)&outline_pool, &outline_capacity, points, sizeof(SDL_Point))) {
+        for (int i = 0; i < item_count; i++) items[i].local = NULL;   // circles only
+    }
+
+    // Count, prefix sum, fill
+    memset(cell_start, 0, sizeof(int) * (cells + 1));
+    int entries = 0;
+    for (int i = 0; i < item_count; i++) {
+        const SpatialItem* it = &items[i];
+        for (int cy = cell_y(it->y - it->r); cy <= cell_y(it->y + it->r); cy++)
+            for (int cx = cell_x(it->x - it->r); cx <= cell_x(it->x + it->r); cx++) {
+                cell_start[cy * grid_w + cx + 1]++;
+                entries++;
+            }
+    }
+    for (int c = 0; c < cells; c++) cell_start[c + 1] += cell_start[c];
+    if (!array_grow((void**)&cell_items, &cell_items_capacity, entries, sizeof(int))) {
+        SDL_Log("Spatial grid: out of memory");
+        item_count = 0;
+        memset(cell_start, 0, sizeof(int) * (cells + 1));
+        return;
+    }
+    memcpy(cell_cursor, cell_start, sizeof(int) * cells);
+    for (int i = 0; i < item_count; i++) {
+        const SpatialItem* it = &items[i];
+        for (int cy = cell_y(it->y - it->r); cy <= cell_y(it->y + it->r); cy++)
+            for (int cx = cell_x(it->x - it->r); cx <= cell_x(it->x + it->r); cx++)
+                cell_items[cell_cursor[cy * grid_w + cx]++] = i;
+    }
+}
+
+void spatial_shutdown(void) {
+    free(cell_index);
+    free(cell_items);
+    free(outline_pool);
+    free(items);
+    free(batch_walks);
+    free(batch_order);
+    cell_index = cell_start = cell_cursor = cell_items = NULL;
+    outline_pool = NULL;
+    items = NULL;
+    batch_walks = NULL;
+    batch_order = NULL;
+    cell_index_capacity = cell_items_capacity = outline_capacity = items_capacity = 0;
+    batch_walks_capacity = batch_order_capacity = 0;
+    item_count = outline_used = 0;
+    grid_w = grid_h = 0;
+}
+
+static const SDL_Point* item_outline(SpatialItem* it) {
+    if (!it->local) return NULL;
+    if (it->outline < 0) {
+        it->outline = outline_used;
+        outline_used += it->local_count;
+        transform_polygon(it->local, &outline_pool[it->outline], it->local_count, sim_entity(it->slot));
+    }
+    return &outline_pool[it->outline];
+}
+
+static bool item_passes(const SpatialItem* it, Uint32 mask, const Entity* ignore) {
+    if (!(it->layer & mask)) return false;
+    return !ignore || it->slot != ignore->slot;
+}
+
+// First sighting of the item in the current query that passes the filter
+static bool item_candidate(SpatialItem* it, Uint32 mask, const Entity* ignore) {
+    if (it->seen == query_stamp) return false;
+    it->seen = query_stamp;
+    return item_passes(it, mask, ignore);
+}
+
+// Whether rebuild filed the item under cell c
+static bool item_in_cell(const SpatialItem* it, int c) {
+    int cx = c % grid_w, cy = c / grid_w;
+    return cell_x(it->x - it->r) <= cx && cx <= cell_x(it->x + it->r) &&
+           cell_y(it->y - it->r) <= cy && cy <= cell_y(it->y + it->r);
+}
+
+// ---- Overlap queries ----
+
+int spatial_query_radius(float x, float y, float radius, Uint32 mask, Entity** out, int max) {
+    if (!grid_w) return 0;
+    query_stamp++;
+
+    int n = 0;
+    for (int cy = cell_y(y - radius); cy <= cell_y(y + radius); cy++) {
+        for (int cx = cell_x(x - radius); cx <= cell_x(x + radius); cx++) {
+            int c = cy * grid_w + cx;
+            for (int k = cell_start[c]; k < cell_start[c + 1] && n < max; k++) {
+                SpatialItem* it = &items[cell_items[k]];
+                if (!item_candidate(it, mask, NULL)) continue;
+
+                float dx = it->x - x, dy = it->y - y;
+                if (dx * dx + dy * dy > (radius + it->r) * (radius + it->r)) continue;
+                const SDL_Point* poly = item_outline(it);
+                if (poly && polygon_point_distance(poly, it->local_count, x, y) > radius) continue;
+                out[n++] = sim_entity(it->slot);
+            }
+        }
+    }
+    return n;
+}
+
+int spatial_query_box(float min_x, float min_y, float max_x, float max_y, Uint32 mask,
+                      Entity** out, int max) {
+    if (!grid_w) return 0;
+    query_stamp++;
+
+    const SDL_Point box[4] = {
+        { (int)floorf(min_x), (int)floorf(min_y) }, { (int)ceilf(max_x), (int)floorf(min_y) },
+        { (int)ceilf(max_x), (int)ceilf(max_y) }, { (int)floorf(min_x), (int)ceilf(max_y) },
+    };
+
+    int n = 0;
+    for (int cy = cell_y(min_y); cy <= cell_y(max_y); cy++) {
+        for (int cx = cell_x(min_x); cx <= cell_x(max_x); cx++) {
+            int c = cy * grid_w + cx;
+            for (int k = cell_start[c]; k < cell_start[c + 1] && n < max; k++) {
+                SpatialItem* it = &items[cell_items[k]];
+                if (!item_candidate(it, mask, NULL)) continue;
+
+                // Bounding circle against the box, then the outline
+                float dx = it->x - fmaxf(min_x, fminf(it->x, max_x));
+                float dy = it->y - fmaxf(min_y, fminf(it->y, max_y));
+                if (dx * dx + dy * dy > it->r * it->r) continue;
+                const SDL_Point* poly = item_outline(it);
+                if (poly && !polygons_intersect_mtv(poly, it->local_count, box, 4, NULL)) continue;
+                out[n++] = sim_entity(it->slot);
+            }
+        }
+    }
+    return n;
+}
+
+// Rings of cells outward from the query cell. An item not seen after ring
+// n lies entirely outside that square, which bounds its center distance.
+int spatial_query_nearest(float x, float y, int k, Uint32 mask, const Entity* ignore, Entity** out) {
+    if (!grid_w || k <= 0) return 0;
+    if (k > SPATIAL_MAX_K) k = SPATIAL_MAX_K;
+    query_stamp++;
+
+    float best_d2[SPATIAL_MAX_K];
+    int best[SPATIAL_MAX_K];
+    int found = 0;
+
+    int qx = cell_x(x), qy = cell_y(y);
+    float cell_x0 = origin_x + qx * SPATIAL_CELL_SIZE, cell_y0 = origin_y + qy * SPATIAL_CELL_SIZE;
+    float margin = fminf(fminf(x - cell_x0, cell_x0 + SPATIAL_CELL_SIZE - x),
+                         fminf(y - cell_y0, cell_y0 + SPATIAL_CELL_SIZE - y));
+    if (margin < 0) margin = 0;    // query point outside the world
+
+    for (int ring = 0; ; ring++) {
+        for (int cy = qy - ring; cy <= qy + ring; cy++) {
+            if (cy < 0 || cy >= grid_h) continue;
+            for (int cx = qx - ring; cx <= qx + ring; cx++) {
+                if (cx < 0 || cx >= grid_w) continue;
+                if (cy != qy - ring && cy != qy + ring && cx != qx - ring && cx != qx + ring) continue;
+
+                int c = cy * grid_w + cx;
+                for (int j = cell_start[c]; j < cell_start[c + 1]; j++) {
+                    SpatialItem* it = &items[cell_items[j]];
+                    if (!item_candidate(it, mask, ignore)) continue;
+
+                    float dx = it->x - x, dy = it->y - y;
+                    float d2 = dx * dx + dy * dy;
+                    if (found == k && d2 >= best_d2[k - 1]) continue;
+
+                    // Insertion into the sorted best list
+                    int pos = found < k ? found++ : k - 1;
+                    while (pos > 0 && best_d2[pos - 1] > d2) {
+                        best_d2[pos] = best_d2[pos - 1];
+                        best[pos] = best[pos - 1];
+                        pos--;
+                    }
+                    best_d2[pos] = d2;
+                    best[pos] = cell_items[j];
+                }
+            }
+        }
+
+        float bound = ring * SPATIAL_CELL_SIZE + margin;
+        if (found == k && best_d2[k - 1] <= bound * bound) break;
+        if (qx - ring <= 0 && qy - ring <= 0 && qx + ring >= grid_w - 1 && qy + ring >= grid_h - 1) break;
+    }
+
+    for (int i = 0; i < found; i++) out[i] = sim_entity(items[best[i]].slot);
+    return found;
+}
+
+// ---- Raycasts ----
+
+// Nearest crossing of p + t*d (t in [0, 1]) with the outline
+static bool segment_polygon(const SDL_Point* poly, int count, float px, float py, float dx, float dy,
+                            float* t_out, float* nx, float* ny) {
+    if (polygon_contains_point(poly, count, px, py)) {
+        float len = sqrtf(dx * dx + dy * dy);
+        *t_out = 0.0f;
+        *nx = -dx / len;
+        *ny = -dy / len;
+        return true;
+    }
+
+    bool hit = false;
+    for (int i = 0, j = count - 1; i < count; j = i++) {
+        float ax = poly[j].x, ay = poly[j].y;
+        float ex = poly[i].x - ax, ey = poly[i].y - ay;
+        float denom = dx * ey - dy * ex;
+        if (fabsf(denom) < 1e-6f) continue;     // parallel
+
+        float wx = ax - px, wy = ay - py;
+        float t = (wx * ey - wy * ex) / denom;
+        float u = (wx * dy - wy * dx) / denom;
+        if (t < 0.0f || t > 1.0f || u < 0.0f || u > 1.0f || (hit && t >= *t_out)) continue;
+
+        // Edge normal, turned to face the ray
+        float len = sqrtf(ex * ex + ey * ey);
+        float ux = -ey / len, uy = ex / len;
+        if (ux * dx + uy * dy > 0) {
+            ux = -ux;
+            uy = -uy;
+        }
+        *t_out = t;
+        *nx = ux;
+        *ny = uy;
+        hit = true;
+    }
+    return hit;
+}
+
+static bool segment_circle(float cx, float cy, float r, float px, float py, float dx, float dy,
+                           float* t_out, float* nx, float* ny) {
+    float fx = px - cx, fy = py - cy;
+    float a = dx * dx + dy * dy;
+    float b = 2.0f * (fx * dx + fy * dy);
+    float c = fx * fx + fy * fy - r * r;
+    float t;
+    if (c <= 0.0f) {
+        t = 0.0f;   // starts inside
+    } else {
+        float disc = b * b - 4.0f * a * c;
+        if (disc < 0.0f || a == 0.0f) return false;
+        t = (-b - sqrtf(disc)) / (2.0f * a);
+        if (t < 0.0f || t > 1.0f) return false;
+    }
+
+    float hx = px + t * dx - cx, hy = py + t * dy - cy;
+    float len = sqrtf(hx * hx + hy * hy);
+    if (len > 0) {
+        *nx = hx / len;
+        *ny = hy / len;
+    } else {
+        float dl = sqrtf(a);
+        *nx = -dx / dl;
+        *ny = -dy / dl;
+    }
+    *t_out = t;
+    return true;
+}
+
+// One item against the ray, keeping the nearest hit in the walk
+static void ray_test_item(const SpatialRay* ray, SpatialItem* it, RayWalk* w, SpatialHit* hit) {
+    float dx = w->dx, dy = w->dy;
+
+    // Bounding circle against the segment first
+    float len2 = dx * dx + dy * dy;
+    float s = len2 > 0 ? ((it->x - ray->x0) * dx + (it->y - ray->y0) * dy) / len2 : 0.0f;
+    s = fmaxf(0.0f, fminf(1.0f, s));
+    float ox = ray->x0 + s * dx - it->x, oy = ray->y0 + s * dy - it->y;
+    if (ox * ox + oy * oy > it->r * it->r) return;
+
+    float t, nx, ny;
+    const SDL_Point* poly = item_outline(it);
+    bool crossed = poly ? segment_polygon(poly, it->local_count, ray->x0, ray->y0, dx, dy, &t, &nx, &ny)
+                        : segment_circle(it->x, it->y, it->r, ray->x0, ray->y0, dx, dy, &t, &nx, &ny);
+    if (!crossed || t >= w->best_t) return;
+
+    w->best_t = t;
+    hit->entity = sim_entity(it->slot);
+    hit->normal_x = nx;
+    hit->normal_y = ny;
+}
+
+// Test every new item in the walk's current cell. Items filed under
+// tested_cell (-1 = none) were already tried against this ray.
+static void ray_test_cell(const SpatialRay* ray, RayWalk* w, int tested_cell, SpatialHit* hit) {
+    int c = w->cy * grid_w + w->cx;
+    for (int k = cell_start[c]; k < cell_start[c + 1]; k++) {
+        SpatialItem* it = &items[cell_items[k]];
+        if (!item_candidate(it, ray->mask, ray->ignore)) continue;
+        if (tested_cell >= 0 && item_in_cell(it, tested_cell)) continue;
+        ray_test_item(ray, it, w, hit);
+    }
+}
+
+// Clip the segment to the grid and set up the walk at its first cell.
+// False if it never enters the grid.
+static bool ray_begin(const SpatialRay* ray, RayWalk* w) {
+    if (!grid_w) return false;
+
+    float dx = ray->x1 - ray->x0, dy = ray->y1 - ray->y0;
+    if (dx == 0.0f && dy == 0.0f) return false;
+
+    // Clip to the grid (Liang-Barsky)
+    float t0 = 0.0f, t1 = 1.0f;
+    float lo[2] = { origin_x, origin_y };
+    float hi[2] = { origin_x + grid_w * SPATIAL_CELL_SIZE, origin_y + grid_h * SPATIAL_CELL_SIZE };
+    float p[2] = { ray->x0, ray->y0 }, d[2] = { dx, dy };
+    for (int axis = 0; axis < 2; axis++) {
+        if (d[axis] == 0.0f) {
+            if (p[axis] < lo[axis] || p[axis] > hi[axis]) return false;
+            continue;
+        }
+        float ta = (lo[axis] - p[axis]) / d[axis], tb = (hi[axis] - p[axis]) / d[axis];
+        if (ta > tb) { float tmp = ta; ta = tb; tb = tmp; }
+        t0 = fmaxf(t0, ta);
+        t1 = fminf(t1, tb);
+    }
+    if (t0 > t1) return false;
+
+    w->dx = dx;
+    w->dy = dy;
+    w->t1 = t1;
+    w->cx = cell_x(ray->x0 + t0 * dx);
+    w->cy = cell_y(ray->y0 + t0 * dy);
+    w->step_x = dx > 0 ? 1 : -1;
+    w->step_y = dy > 0 ? 1 : -1;
+    w->delta_x = dx != 0.0f ? SPATIAL_CELL_SIZE / fabsf(dx) : FLT_MAX;
+    w->delta_y = dy != 0.0f ? SPATIAL_CELL_SIZE / fabsf(dy) : FLT_MAX;
+    w->next_x = dx != 0.0f ? (origin_x + (w->cx + (dx > 0)) * SPATIAL_CELL_SIZE - ray->x0) / dx : FLT_MAX;
+    w->next_y = dy != 0.0f ? (origin_y + (w->cy + (dy > 0)) * SPATIAL_CELL_SIZE - ray->y0) / dy : FLT_MAX;
+    w->best_t = FLT_MAX;
+    return true;
+}
+
+// Step to the next cell; false once the nearest hit lies before the
+// current cell's exit, or the segment has left the grid
+static bool ray_advance(RayWalk* w) {
+    float cell_exit = fminf(w->next_x, w->next_y);
+    if (w->best_t <= cell_exit || cell_exit > w->t1) return false;
+    if (w->next_x < w->next_y) {
+        w->cx += w->step_x;
+        w->next_x += w->delta_x;
+    } else {
+        w->cy += w->step_y;
+        w->next_y += w->delta_y;
+    }
+    return w->cx >= 0 && w->cy >= 0 && w->cx < grid_w && w->cy < grid_h;
+}
+
+static bool ray_finish(const SpatialRay* ray, const RayWalk* w, SpatialHit* hit) {
+    if (!hit->entity) return false;
+    hit->x = ray->x0 + w->best_t * w->dx;
+    hit->y = ray->y0 + w->best_t * w->dy;
+    hit->distance = w->best_t * sqrtf(w->dx * w->dx + w->dy * w->dy);
+    return true;
+}
+
+// Grid walk from the start cell, stopping once the nearest hit lies before
+// the next cell boundary
+bool spatial_raycast(const SpatialRay* ray, SpatialHit* hit) {
+    memset(hit, 0, sizeof(*hit));
+    RayWalk w;
+    if (!ray_begin(ray, &w)) return false;
+
+    query_stamp++;
+    do {
+        ray_test_cell(ray, &w, -1, hit);
+    } while (ray_advance(&w));
+    return ray_finish(ray, &w, hit);
+}
+
+static int compare_start_cell(const void* a, const void* b) {
+    const BatchRay* x = a;
+    const BatchRay* y = b;
+    if (x->cell != y->cell) return x->cell < y->cell ? -1 : 1;
+    return x->ray - y->ray;
+}
+
+int spatial_raycast_batch(const SpatialRay* rays, int count, SpatialHit* hits) {
+    if (!array_grow((void**)&batch_walks, &batch_walks_capacity, count, sizeof(RayWalk)) ||
+        !array_grow((void**)&batch_order, &batch_order_capacity, count, sizeof(BatchRay))) {
+        // No scratch space: one ray at a time gives the same answers
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (spatial_raycast(&rays[i], &hits[i])) n++;
+        }
+        return n;
+    }
+
+    // Rays fired from the same place (a burst, a turret) share a start cell
+    int queued = 0;
+    for (int i = 0; i < count; i++) {
+        memset(&hits[i], 0, sizeof(hits[i]));
+        if (ray_begin(&rays[i], &batch_walks[i]))
+            batch_order[queued++] = (BatchRay){ batch_walks[i].cy * grid_w + batch_walks[i].cx, i };
+    }
+    qsort(batch_order, queued, sizeof(BatchRay), compare_start_cell);
+
+    for (int g = 0; g < queued;) {
+        int c = batch_order[g].cell;
+        int end = g;
+        while (end < queued && batch_order[end].cell == c) end++;
+
+        // The shared cell: each item is read and transformed once for the
+        // whole group. A cell lists an item once, so no stamp is needed.
+        for (int k = cell_start[c]; k < cell_start[c + 1]; k++) {
+            SpatialItem* it = &items[cell_items[k]];
+            for (int j = g; j < end; j++) {
+                int r = batch_order[j].ray;
+                if (item_passes(it, rays[r].mask, rays[r].ignore))
+                    ray_test_item(&rays[r], it, &batch_walks[r], &hits[r]);
+            }
+        }
+
+        // Past it the walks part ways
+        for (int j = g; j < end; j++) {
+            int r = batch_order[j].ray;
+            query_stamp++;
+            while (ray_advance(&batch_walks[r]))
+                ray_test_cell(&rays[r], &batch_walks[r], c, &hits[r]);
+        }
+        g = end;
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (ray_finish(&rays[i], &batch_walks[i], &hits[i])) n++;
+    }
+    return n;
+}
@@ -0,0 +1,51 @@
+#ifndef SPATIAL_QUERY_H
+#define SPATIAL_QUERY_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+
+#define SPATIAL_CELL_SIZE 128.0f     // world units per grid cell
+#define SPATIAL_MAX_K 32             // largest k for spatial_query_nearest
+
+typedef struct {
+    Entity* entity;
+    float distance;             // from the ray origin, world units
+    float x, y;                 // hit point
+    float normal_x, normal_y;   // unit surface normal, facing the ray
+} SpatialHit;
+
+typedef struct {
+    float x0, y0, x1, y1;       // segment
+    Uint32 mask;                // collider layers that can be hit
+    const Entity* ignore;       // typically the shooter, may be NULL
+} SpatialRay;
+
+// Uniform grid over the active colliders, bucketed by bounding circle.
+// Rebuild once per tick before the first query; queries see the colliders
+// as of the last rebuild. Derived data, not part of SimState.
+void spatial_rebuild(void);
+void spatial_shutdown(void);
+
+// Entities whose collider layer is in mask and whose outline overlaps the
+// circle or box. Return the number written to out (at most max).
+int spatial_query_radius(float x, float y, float radius, Uint32 mask, Entity** out, int max);
+int spatial_query_box(float min_x, float min_y, float max_x, float max_y, Uint32 mask,
+                      Entity** out, int max);
+
+// The k nearest by collider center, closest first
+int spatial_query_nearest(float x, float y, int k, Uint32 mask, const Entity* ignore, Entity** out);
+
+// First outline crossed by the segment inside the world bounds. A ray
+// that starts inside an outline hits it at distance 0.
+bool spatial_raycast(const SpatialRay* ray, SpatialHit* hit);
+
+// Many rays in one call, e.g. every bullet of a tick. Rays are grouped by
+// the cell they start in (or enter the grid through): each group reads that
+// cell's items once for all its rays, then each ray walks on alone.
+// Outlines are transformed at most once per rebuild and shared by all rays.
+// Same hits as spatial_raycast on each ray; hits[i].entity is NULL on a
+// miss. Returns the number of rays that hit.
+int spatial_raycast_batch(const SpatialRay* rays, int count, SpatialHit* hits);
+
+#endif
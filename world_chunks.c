@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cjson/cJSON.h>
+#include "world_chunks.h"
+#include "collision.h"
+#include "hitbox_loader.h"
+#include "sim_state.h"
+#include "navigation.h"
+#include "asset_loader.h"
+
+static WorldChunk* chunks = NULL;
+static int chunks_x = 0, chunks_y = 0;
+static int loaded_count = 0;
+static char* chunk_root = NULL;
+static SDL_Renderer* chunk_renderer = NULL;
+static ARRAY(Entity*) gathered;     // world_chunks_gather's result
+
+static char* read_chunk_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = (len >= 0) ? malloc(len + 1) : NULL;
+    if (!data) {
+        fclose(f);
+        return NULL;
+    }
+    size_t got = fread(data, 1, len, f);
+    data[got] = '\0';
+    fclose(f);
+    return data;
+}
+
+static int chunk_index(const WorldChunk* c) {
+    return (int)(c - chunks);
+}
+
+// Kept in slot order, so a resync rebuilds the list exactly and gather
+// order (which contact resolution follows) survives a rollback
+static bool chunk_list_insert(WorldChunk* c, Entity* e) {
+    if (c->entity_count == c->entity_capacity) {
+        int cap = c->entity_capacity ? c->entity_capacity * 2 : 8;
+        Entity** grown = realloc(c->entities, sizeof(Entity*) * cap);
+        if (!grown) return false;
+        c->entities = grown;
+        c->entity_capacity = cap;
+    }
+    int i = c->entity_count++;
+    while (i > 0 && c->entities[i - 1]->slot > e->slot) {
+        c->entities[i] = c->entities[i - 1];
+        i--;
+    }
+    c->entities[i] = e;
+    return true;
+}
+
+static void chunk_add_entity(WorldChunk* c, Entity* e) {
+    if (!chunk_list_insert(c, e)) {
+        entity_destroy(e);
+        return;
+    }
+    sim_links(e)->chunk = (Sint16)chunk_index(c);
+}
+
+// NULL for an empty chunk (no file) or one that does not parse
+static cJSON* read_chunk_json(int cx, int cy) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/chunk_%d_%d.json", chunk_root, cx, cy);
+    char* data = read_chunk_file(path);
+    if (!data) return NULL;
+
+    cJSON* root = cJSON_Parse(data);
+    free(data);
+    if (!root) SDL_Log("Failed to parse chunk %s", path);
+    return root;
+}
+
+static void chunk_load(WorldChunk* c) {
+    sim.chunk_loaded[chunk_index(c)] = true;
+    loaded_count++;
+
+    cJSON* root = read_chunk_json(c->cx, c->cy);
+    if (!root) return;
+
+    cJSON* list = cJSON_GetObjectItem(root, "entities");
+    int count = cJSON_GetArraySize(list);
+    for (int i = 0; i < count; i++) {
+        cJSON* item = cJSON_GetArrayItem(list, i);
+        cJSON* id = cJSON_GetObjectItem(item, "id");
+        cJSON* texture = cJSON_GetObjectItem(item, "texture");
+        cJSON* x = cJSON_GetObjectItem(item, "x");
+        cJSON* y = cJSON_GetObjectItem(item, "y");
+        if (!id || !id->valuestring || !texture || !texture->valuestring || !x || !y) continue;
+
+        Entity* e = spawn_entity(id->valuestring, chunk_renderer, texture->valuestring,
+                                 (float)x->valuedouble, (float)y->valuedouble);
+        if (!e) continue;
+
+        cJSON* angle = cJSON_GetObjectItem(item, "angle");
+        if (angle) entity_set_angle(e, (float)angle->valuedouble);
+
+        // Scenery does not move
+        e->max_speed = 0;
+        e->friction = 0;
+
+        // Shapes missing from the registry can be named per entity
+        cJSON* hitbox = cJSON_GetObjectItem(item, "hitbox");
+        if (!get_collider(e) && hitbox && hitbox->valuestring)
+            load_entity_hitbox(e, hitbox->valuestring);
+        // Scenery unless the hitbox data chose a filter of its own
+        const HitboxShape* hs = hitbox_registry_find(entity_cold(e)->id);
+        collider_set_filter(e, hs && hs->layer ? hs->layer : COLLISION_LAYER_SCENERY,
+                            hs && hs->mask ? hs->mask : COLLISION_LAYER_VEHICLE | COLLISION_LAYER_BULLET);
+        // Already in the nav grid: world_chunks_init rasterized every chunk
+
+        chunk_add_entity(c, e);
+    }
+
+    cJSON_Delete(root);
+}
+
+static void chunk_unload(WorldChunk* c) {
+    // entity_destroy also drops the collider, so the chunk leaves collision too
+    for (int i = 0; i < c->entity_count; i++)
+        entity_destroy(c->entities[i]);
+
+    free(c->entities);
+    c->entities = NULL;
+    c->entity_count = 0;
+    c->entity_capacity = 0;
+    sim.chunk_loaded[chunk_index(c)] = false;
+    loaded_count--;
+}
+
+// World outline of a rock that is not spawned: its registry shape, or the
+// sprite box. Circles and oversized outlines use their bounding box, which
+// is conservative enough for path planning.
+static int scenery_outline(const char* id, Entity* at, SDL_Point* out) {
+    const HitboxShape* hs = hitbox_registry_find(id);
+    SDL_Point local[4] = { { 0, 0 }, { at->width, 0 }, { at->width, at->height }, { 0, at->height } };
+    if (hs && hs->radius <= 0 && hs->point_count >= 3 && hs->point_count <= COLLISION_STACK_POINTS) {
+        transform_polygon(hs->points, out, hs->point_count, at);
+        return hs->point_count;
+    }
+    if (hs && hs->radius > 0) {
+        int x = hs->points[0].x, y = hs->points[0].y, r = (int)ceilf(hs->radius);
+        local[0] = (SDL_Point){ x - r, y - r };
+        local[1] = (SDL_Point){ x + r, y - r };
+        local[2] = (SDL_Point){ x + r, y + r };
+        local[3] = (SDL_Point){ x - r, y + r };
+    }
+    transform_polygon(local, out, 4, at);
+    return 4;
+}
+
+// Every rock of every chunk, so agents plan around scenery nobody has
+// streamed in yet. Reads the files without spawning anything.
+static void rasterize_all_chunks(void) {
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        cJSON* root = read_chunk_json(chunks[i].cx, chunks[i].cy);
+        if (!root) continue;
+
+        cJSON* list = cJSON_GetObjectItem(root, "entities");
+        int count = cJSON_GetArraySize(list);
+        for (int k = 0; k < count; k++) {
+            cJSON* item = cJSON_GetArrayItem(list, k);
+            cJSON* id = cJSON_GetObjectItem(item, "id");
+            cJSON* texture = cJSON_GetObjectItem(item, "texture");
+            cJSON* x = cJSON_GetObjectItem(item, "x");
+            cJSON* y = cJSON_GetObjectItem(item, "y");
+            if (!id || !id->valuestring || !texture || !texture->valuestring || !x || !y) continue;
+
+            Entity at = { 0 };
+            if (!asset_image_size(texture->valuestring, &at.width, &at.height)) continue;
+            at.x = (float)x->valuedouble;
+            at.y = (float)y->valuedouble;
+            cJSON* angle = cJSON_GetObjectItem(item, "angle");
+            entity_set_angle(&at, angle ? (float)angle->valuedouble : 0.0f);
+
+            SDL_Point outline[COLLISION_STACK_POINTS];
+            nav_add_outline(outline, scenery_outline(id->valuestring, &at, outline));
+        }
+        cJSON_Delete(root);
+    }
+}
+
+bool world_chunks_init(SDL_Renderer* renderer, const char* chunk_dir) {
+    WorldBounds wb = world_get_bounds();
+    chunks_x = (int)ceilf((wb.max_x - wb.min_x) / CHUNK_SIZE);
+    chunks_y = (int)ceilf((wb.max_y - wb.min_y) / CHUNK_SIZE);
+    if (chunks_x < 1) chunks_x = 1;
+    if (chunks_y < 1) chunks_y = 1;
+    if (chunks_x * chunks_y > SIM_MAX_CHUNKS) {
+        SDL_Log("World needs %d chunks, at most %d supported", chunks_x * chunks_y, SIM_MAX_CHUNKS);
+        return false;
+    }
+
+    chunks = calloc(chunks_x * chunks_y, sizeof(WorldChunk));
+    if (!chunks) return false;
+
+    for (int cy = 0; cy < chunks_y; cy++) {
+        for (int cx = 0; cx < chunks_x; cx++) {
+            chunks[cy * chunks_x + cx].cx = cx;
+            chunks[cy * chunks_x + cx].cy = cy;
+        }
+    }
+
+    chunk_root = strdup(chunk_dir);
+    chunk_renderer = renderer;
+    memset(sim.chunk_loaded, 0, sizeof(sim.chunk_loaded));
+    loaded_count = 0;
+    rasterize_all_chunks();
+    return true;
+}
+
+void world_chunks_shutdown(void) {
+    for (int i = 0; i < chunks_x * chunks_y && chunks; i++) {
+        if (sim.chunk_loaded[i]) chunk_unload(&chunks[i]);
+    }
+    free(chunks);
+    free(chunk_root);
+    array_free(&gathered);
+    chunks = NULL;
+    chunk_root = NULL;
+    chunks_x = chunks_y = 0;
+}
+
+// Gap between a chunk and a camera's view rect (0 when overlapping)
+static float chunk_view_gap(float min_x, float min_y, float max_x, float max_y, const Camera* cam) {
+    float half_w = cam->view_w / (2.0f * cam->zoom);
+    float half_h = cam->view_h / (2.0f * cam->zoom);
+    float gap_x = fmaxf(0.0f, fmaxf(min_x - (cam->x + half_w), (cam->x - half_w) - max_x));
+    float gap_y = fmaxf(0.0f, fmaxf(min_y - (cam->y + half_h), (cam->y - half_h) - max_y));
+    return fmaxf(gap_x, gap_y);
+}
+
+void world_chunks_update(const Camera* cam) {
+    world_chunks_update_views(cam, cam ? 1 : 0);
+}
+
+void world_chunks_update_views(const Camera* cams, int count) {
+    if (!chunks || !cams || count <= 0) return;
+
+    WorldBounds wb = world_get_bounds();
+
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        WorldChunk* c = &chunks[i];
+        float min_x = wb.min_x + c->cx * CHUNK_SIZE;
+        float min_y = wb.min_y + c->cy * CHUNK_SIZE;
+        float max_x = min_x + CHUNK_SIZE;
+        float max_y = min_y + CHUNK_SIZE;
+
+        // The closest view decides
+        float gap = chunk_view_gap(min_x, min_y, max_x, max_y, &cams[0]);
+        for (int v = 1; v < count; v++)
+            gap = fminf(gap, chunk_view_gap(min_x, min_y, max_x, max_y, &cams[v]));
+
+        bool loaded = sim.chunk_loaded[i];
+        if (!loaded && gap <= CHUNK_LOAD_MARGIN)
+            chunk_load(c);
+        else if (loaded && gap > CHUNK_UNLOAD_MARGIN)
+            chunk_unload(c);
+    }
+}
+
+void world_chunks_render(SDL_Renderer* renderer) {
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        const WorldChunk* c = &chunks[i];
+        if (!sim.chunk_loaded[i]) continue;
+        for (int j = 0; j < c->entity_count; j++) {
+            Entity* e = c->entities[j];
+            entity_render(renderer, e, e->width, e->height);
+        }
+    }
+}
+
+Entity** world_chunks_gather(int* count) {
+    int total = 0;
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        if (sim.chunk_loaded[i]) total += chunks[i].entity_count;
+    }
+    gathered.count = 0;
+    if (!array_reserve(&gathered, total)) {
+        SDL_Log("Out of memory gathering %d scenery entities", total);
+        *count = 0;
+        return gathered.items;
+    }
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        const WorldChunk* c = &chunks[i];
+        if (!sim.chunk_loaded[i]) continue;
+        for (int j = 0; j < c->entity_count; j++)
+            gathered.items[gathered.count++] = c->entities[j];
+    }
+    *count = gathered.count;
+    return gathered.items;
+}
+
+int world_chunks_loaded_count(void) {
+    return loaded_count;
+}
+
+void world_chunks_resync(void) {
+    loaded_count = 0;
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        chunks[i].entity_count = 0;
+        if (sim.chunk_loaded[i]) loaded_count++;
+    }
+    for (int slot = 0; slot < sim.entity_count; slot++) {
+        const EntityLinks* links = sim_link(slot);
+        if (!links->in_use || links->chunk < 0 || links->chunk >= chunks_x * chunks_y) continue;
+        if (!chunk_list_insert(&chunks[links->chunk], sim_entity(slot)))
+            SDL_Log("Chunk resync: out of memory");
+    }
+}
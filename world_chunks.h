@@ -0,0 +1,44 @@
+#ifndef WORLD_CHUNKS_H
+#define WORLD_CHUNKS_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "entity.h"
+#include "camera.h"
+
+#define CHUNK_SIZE 750.0f             // world units per chunk side
+#define CHUNK_LOAD_MARGIN 200.0f      // load when this close to the view
+#define CHUNK_UNLOAD_MARGIN 600.0f    // unload only once this far away
+
+// Whether a chunk is loaded is simulation state (sim.chunk_loaded); the
+// entity list is a cache of the pool entities whose links name the chunk
+typedef struct {
+    int cx, cy;
+    Entity** entities;          // slot order
+    int entity_count;
+    int entity_capacity;
+} WorldChunk;
+
+// Static scenery is read from <chunk_dir>/chunk_<cx>_<cy>.json on demand.
+// A missing file is an empty chunk. Init also rasterizes every chunk's
+// rocks into the nav grid, so call it after nav_init and the hitbox registry.
+bool world_chunks_init(SDL_Renderer* renderer, const char* chunk_dir);
+void world_chunks_shutdown(void);
+
+// Load chunks near the camera view and unload far ones (with hysteresis)
+void world_chunks_update(const Camera* cam);
+
+// Same for several views at once (server: one per player); a chunk stays
+// loaded while any view is near it
+void world_chunks_update_views(const Camera* cams, int count);
+
+// Render and enumerate scenery of loaded chunks only
+void world_chunks_render(SDL_Renderer* renderer);
+// Gather returns a buffer owned by this module, valid until the next gather
+Entity** world_chunks_gather(int* count);
+int  world_chunks_loaded_count(void);
+
+// Rebuild the entity lists from the pool after sim_state_restore
+void world_chunks_resync(void);
+
+#endif